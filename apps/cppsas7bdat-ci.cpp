@@ -9,9 +9,14 @@
 #include <cppsas7bdat/version.hpp>
 #include <cppsas7bdat/reader.hpp>
 #include <cppsas7bdat/source/ifstream.hpp>
+#include <cppsas7bdat/source/mmap.hpp>
+#include <cppsas7bdat/source/prefetch.hpp>
+#include <cppsas7bdat/source/trusted.hpp>
+#include <cppsas7bdat/source/uring.hpp>
 #include <cppsas7bdat/sink/print.hpp>
 #include <cppsas7bdat/sink/csv.hpp>
 #include <cppsas7bdat/sink/null.hpp>
+#include <cppsas7bdat/sink/null_plan.hpp>
 #include <docopt/docopt.h>
 
 namespace {
@@ -19,9 +24,9 @@ namespace {
 R"(SAS7BDAT file reader
 
      Usage:
-       cppsas7bdat-ci print [--nlines=<lines>] <file>...
-       cppsas7bdat-ci csv <file>...
-       cppsas7bdat-ci null <file>...
+       cppsas7bdat-ci print [--source=<source>] [--depth=<n>] [--trusted] [--nlines=<lines>] <file>...
+       cppsas7bdat-ci csv [--source=<source>] [--depth=<n>] [--trusted] [--utf8] [--threads=<n>] <file>...
+       cppsas7bdat-ci null [--source=<source>] [--depth=<n>] [--trusted] [--plan] [--threads=<n>] <file>...
        cppsas7bdat-ci (-h|--help)
        cppsas7bdat-ci (-v|--version)
 
@@ -29,17 +34,53 @@ R"(SAS7BDAT file reader
        -h --help                    Show this screen.
        -v --version                 Show version.
        -n=<lines> --nlines=<lines>  Read at most n lines
+       -s=<source> --source=<source>  Data source: ifstream, mmap, prefetch or uring [default: ifstream]
+       -d=<n> --depth=<n>           Pages read ahead by the prefetch and uring sources
+       -t=<n> --threads=<n>         Decode the pages with n threads [default: 1]
+       --trusted                    Skip the bounds checks when decoding the rows
+       --plan                       Decode the values with a decode plan
+       --utf8                       Convert the strings to UTF-8
 )";
 }
 
-void process_print(const std::string& _filename, long _n)
+template<typename _Fct>
+void with_source(const std::string& _source, const size_t _depth, const std::string& _filename, _Fct _fct)
 {
-  cppsas7bdat::Reader reader(cppsas7bdat::datasource::ifstream(_filename.c_str()), cppsas7bdat::datasink::print(std::cout));
-  while(_n != 0 && reader.read_row()) {
-    if(_n > 0) --_n;
+  if(_source == "mmap") {
+    _fct(cppsas7bdat::datasource::mmap(_filename.c_str()));
+  } else if(_source == "prefetch") {
+    if(_depth) _fct(cppsas7bdat::datasource::prefetch(cppsas7bdat::datasource::ifstream(_filename.c_str()), _depth));
+    else _fct(cppsas7bdat::datasource::prefetch(cppsas7bdat::datasource::ifstream(_filename.c_str())));
+  } else if(_source == "uring") {
+    if(_depth) _fct(cppsas7bdat::datasource::uring(_filename.c_str(), _depth));
+    else _fct(cppsas7bdat::datasource::uring(_filename.c_str()));
+  } else {
+    _fct(cppsas7bdat::datasource::ifstream(_filename.c_str()));
   }
 }
 
+template<typename _Fct>
+void with_source(const std::string& _source, const size_t _depth, const bool _trusted, const std::string& _filename, _Fct _fct)
+{
+  with_source(_source, _depth, _filename, [&](auto&& _datasource) {
+    if(_trusted) {
+      _fct(cppsas7bdat::datasource::trusted(std::move(_datasource)));
+    } else {
+      _fct(std::move(_datasource));
+    }
+  });
+}
+
+void process_print(const std::string& _source, const size_t _depth, const bool _trusted, const std::string& _filename, long _n)
+{
+  with_source(_source, _depth, _trusted, _filename, [&](auto&& _datasource) {
+    cppsas7bdat::Reader reader(std::move(_datasource), cppsas7bdat::datasink::print(std::cout));
+    while(_n != 0 && reader.read_row()) {
+      if(_n > 0) --_n;
+    }
+  });
+}
+
 std::string get_csv_filename(const std::string& _filename)
 {
   auto ipos = _filename.rfind('.');
@@ -49,19 +90,28 @@ std::string get_csv_filename(const std::string& _filename)
   return _filename + "csv";
 }
 
-void process_csv(const std::string& _filename)
+void process_csv(const std::string& _source, const size_t _depth, const bool _trusted, const std::string& _filename, const size_t _nthreads, const bool _utf8)
 {
   const auto csv_filename = get_csv_filename(_filename);
   //std::ofstream csv_os(csv_filename.c_str());
   //cppsas7bdat::Reader reader(cppsas7bdat::datasource::ifstream(_filename.c_str()), cppsas7bdat::datasink::csv(csv_os));
-  cppsas7bdat::Reader reader(cppsas7bdat::datasource::ifstream(_filename.c_str()), cppsas7bdat::datasink::csv(_filename.c_str()));
-  reader.read_all();
+  with_source(_source, _depth, _trusted, _filename, [&](auto&& _datasource) {
+    cppsas7bdat::Reader reader(std::move(_datasource), cppsas7bdat::datasink::csv(_filename.c_str(), _utf8));
+    reader.read_all(_nthreads);
+  });
 }
 
-void process_null(const std::string& _filename)
+void process_null(const std::string& _source, const size_t _depth, const bool _trusted, const std::string& _filename, const size_t _nthreads, const bool _plan)
 {
-  cppsas7bdat::Reader reader(cppsas7bdat::datasource::ifstream(_filename.c_str()), cppsas7bdat::datasink::null());
-  reader.read_all();
+  with_source(_source, _depth, _trusted, _filename, [&](auto&& _datasource) {
+    if(_plan) {
+      cppsas7bdat::Reader reader(std::move(_datasource), cppsas7bdat::datasink::null_plan());
+      reader.read_all(_nthreads);
+    } else {
+      cppsas7bdat::Reader reader(std::move(_datasource), cppsas7bdat::datasink::null());
+      reader.read_all(_nthreads);
+    }
+  });
 }
 
 int main(const int argc, char* argv[])
@@ -75,21 +125,27 @@ int main(const int argc, char* argv[])
     for (auto const &arg : args) {
       std::cout << arg.first << " = " << arg.second << std::endl;
     }
+  const auto source = args["--source"] ? args["--source"].asString() : std::string("ifstream");
+  const size_t depth = args["--depth"] ? static_cast<size_t>(args["--depth"].asLong()) : 0;
+  const bool trusted = args["--trusted"] && args["--trusted"].asBool();
+  const size_t nthreads = args["--threads"] ? static_cast<size_t>(args["--threads"].asLong()) : 1;
   if(args["print"].asBool()) {
     const auto n = args["--nlines"] ? args["--nlines"].asLong() : -1;
     const auto files = args["<file>"].asStringList();
     for(const auto& file: files) {
-      process_print(file, n);
+      process_print(source, depth, trusted, file, n);
     }
   } else if(args["csv"].asBool()) {
+    const bool utf8 = args["--utf8"] && args["--utf8"].asBool();
     const auto files = args["<file>"].asStringList();
     for(const auto& file: files) {
-      process_csv(file);
+      process_csv(source, depth, trusted, file, nthreads, utf8);
     }
   } else if(args["null"].asBool()) {
+    const bool plan = args["--plan"] && args["--plan"].asBool();
     const auto files = args["<file>"].asStringList();
     for(const auto& file: files) {
-      process_null(file);
+      process_null(source, depth, trusted, file, nthreads, plan);
     }
   }
   return 0;
@@ -2,6 +2,11 @@
 
 hyperfine --warmup 1 \
 	  "../build/Release/apps/cppsas7bdat-ci null $1" \
+	  "../build/Release/apps/cppsas7bdat-ci null --source=mmap $1" \
+	  "../build/Release/apps/cppsas7bdat-ci null --source=prefetch $1" \
+	  "../build/Release/apps/cppsas7bdat-ci null --source=uring $1" \
+	  "../build/Release/apps/cppsas7bdat-ci null --trusted $1" \
+	  "../build/Release/apps/cppsas7bdat-ci null --plan $1" \
 	  "python3 ./cppsas7bdat.py -f $1 -s sink" \
 	  "python3 ./cppsas7bdat.py -f $1 -s chunk" \
 	  "python3 ./cppsas7bdat.py -f $1 -s pd_sink" \
@@ -13,6 +18,15 @@ hyperfine --warmup 1 \
 	  #"python3 ./pysas7bdat.py $1" \
 	  #"julia -e 'using SASLib; readsas(ARGS[1]);' $1" \
 
+# Pages in flight of the uring data source against the ifstream one
+hyperfine --warmup 1 --parameter-list depth 1,2,4,8,16,32 \
+	  --reference "../build/Release/apps/cppsas7bdat-ci null $1" \
+	  "../build/Release/apps/cppsas7bdat-ci null --source=uring --depth={depth} $1"
+
+# Scaling of the multi-threaded page decoding
+hyperfine --warmup 1 --parameter-list threads 1,2,4,8,16,32 \
+	  "../build/Release/apps/cppsas7bdat-ci null --threads={threads} $1"
+
 Rscript benchmark.R $1
 
 julia -e 'using BenchmarkTools; using SASLib; @btime redirect_stdout(open(tempname(), "w")) do; readsas(ARGS[1]) end;' $1
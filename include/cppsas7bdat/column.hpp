@@ -9,9 +9,11 @@
 #ifndef _CPP_SAS7BDAT_COLUMN_HPP_
 #define _CPP_SAS7BDAT_COLUMN_HPP_
 
+#include <cppsas7bdat/row_batch.hpp>
 #include <cppsas7bdat/types.hpp>
 #include <iosfwd>
 #include <memory>
+#include <optional>
 
 namespace cppsas7bdat {
 
@@ -19,6 +21,25 @@ struct Column {
   enum class Type { unknown, string, number, integer, datetime, date, time };
   using PBUF = const void *;
 
+  /// Operation decoding the raw value, see DecodePlan.
+  enum class Op : uint8_t {
+    none, /**< Only through the getters */
+    string,
+    uint8,
+    int16,
+    number, /**< Double of 3 to 8 bytes */
+    datetime,
+    date,
+    time
+  };
+  /// Position and encoding of the value in the row.
+  struct Layout {
+    size_t offset{0};
+    size_t length{0};
+    Op op{Op::none};
+    Endian endian{Endian::unknown};
+  };
+
 private:
   struct FormatterConcept;
   using PIMPL = std::shared_ptr<FormatterConcept>;
@@ -32,10 +53,20 @@ private:
     virtual DATETIME get_datetime(PBUF _p) const = 0;
     virtual DATE get_date(PBUF _p) const = 0;
     virtual TIME get_time(PBUF _p) const = 0;
+    virtual EPOCH get_epoch(PBUF _p) const = 0;
 
     virtual STRING to_string(PBUF _p) const = 0;
 
+    virtual void get_strings(const RowBatch &_rows, SV *_out) const = 0;
+    virtual void get_numbers(const RowBatch &_rows, NUMBER *_out) const = 0;
+    virtual void get_integers(const RowBatch &_rows, INTEGER *_out) const = 0;
+    virtual void get_epochs(const RowBatch &_rows, EPOCH *_out) const = 0;
+    virtual void get_validity(const RowBatch &_rows, uint8_t *_validity,
+                              char *_codes) const = 0;
+
     virtual size_t length() const noexcept = 0;
+    virtual std::optional<size_t> offset() const noexcept = 0;
+    virtual Layout layout() const noexcept = 0;
   };
 
   template <typename _Fp> struct FormatterModel : public FormatterConcept {
@@ -63,10 +94,85 @@ private:
 
     TIME get_time(PBUF _p) const final { return formatter.get_time(_p); }
 
+    EPOCH get_epoch(PBUF _p) const final {
+      if constexpr (requires { formatter.get_epoch(_p); })
+        return formatter.get_epoch(_p);
+      else
+        return EPOCH_NA;
+    }
+
     STRING to_string(PBUF _p) const final { return formatter.to_string(_p); }
 
+    // The formatter can provide its own loops, otherwise the values are
+    // extracted one by one (without virtual call).
+    void get_strings(const RowBatch &_rows, SV *_out) const final {
+      if constexpr (requires { formatter.get_strings(_rows, _out); })
+        formatter.get_strings(_rows, _out);
+      else
+        for (size_t i = 0; i < _rows.size(); ++i)
+          _out[i] = formatter.get_string(_rows[i]);
+    }
+
+    void get_numbers(const RowBatch &_rows, NUMBER *_out) const final {
+      if constexpr (requires { formatter.get_numbers(_rows, _out); })
+        formatter.get_numbers(_rows, _out);
+      else
+        for (size_t i = 0; i < _rows.size(); ++i)
+          _out[i] = formatter.get_number(_rows[i]);
+    }
+
+    void get_integers(const RowBatch &_rows, INTEGER *_out) const final {
+      if constexpr (requires { formatter.get_integers(_rows, _out); })
+        formatter.get_integers(_rows, _out);
+      else
+        for (size_t i = 0; i < _rows.size(); ++i)
+          _out[i] = formatter.get_integer(_rows[i]);
+    }
+
+    void get_epochs(const RowBatch &_rows, EPOCH *_out) const final {
+      if constexpr (requires { formatter.get_epochs(_rows, _out); })
+        formatter.get_epochs(_rows, _out);
+      else
+        for (size_t i = 0; i < _rows.size(); ++i)
+          _out[i] = get_epoch(_rows[i]);
+    }
+
+    void get_validity(const RowBatch &_rows, uint8_t *_validity,
+                      char *_codes) const final {
+      if constexpr (requires {
+                      formatter.get_validity(_rows, _validity, _codes);
+                    })
+        formatter.get_validity(_rows, _validity, _codes);
+      else
+        for (size_t i = 0; i < _rows.size(); ++i) {
+          if (i % 8 == 0)
+            _validity[i / 8] = 0;
+          _validity[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+          if (_codes)
+            _codes[i] = 0;
+        }
+    }
+
     size_t length() const noexcept final { return formatter.length; }
 
+    std::optional<size_t> offset() const noexcept final {
+      if constexpr (requires { formatter.offset; })
+        return formatter.offset;
+      else
+        return {};
+    }
+
+    Layout layout() const noexcept final {
+      if constexpr (requires {
+                      _Fp::op;
+                      _Fp::endian;
+                      formatter.offset;
+                    })
+        return {formatter.offset, formatter.length, _Fp::op, _Fp::endian};
+      else
+        return {};
+    }
+
   private:
     _Fp formatter;
   };
@@ -100,10 +206,58 @@ public:
   DATETIME get_datetime(PBUF _p) const { return pimpl->get_datetime(_p); }
   DATE get_date(PBUF _p) const { return pimpl->get_date(_p); }
   TIME get_time(PBUF _p) const { return pimpl->get_time(_p); }
+  /// Datetime and time: microseconds since 1970-01-01 and since midnight,
+  /// date: days since 1970-01-01; EPOCH_NA if missing or for the other
+  /// types.  Same rounding as get_datetime, get_date and get_time.
+  EPOCH get_epoch(PBUF _p) const { return pimpl->get_epoch(_p); }
 
   STRING to_string(PBUF _p) const { return pimpl->to_string(_p); }
 
+  /// Extract the values of the column for all the rows of _rows at once.
+  void get_strings(const RowBatch &_rows, SV *_out) const {
+    pimpl->get_strings(_rows, _out);
+  }
+  void get_numbers(const RowBatch &_rows, NUMBER *_out) const {
+    pimpl->get_numbers(_rows, _out);
+  }
+  void get_integers(const RowBatch &_rows, INTEGER *_out) const {
+    pimpl->get_integers(_rows, _out);
+  }
+  void get_epochs(const RowBatch &_rows, EPOCH *_out) const {
+    pimpl->get_epochs(_rows, _out);
+  }
+  /// Validity bitmap of the rows of _rows, Arrow's layout: the bit i % 8
+  /// of _validity[i / 8] is set if the value i is not missing, the bits
+  /// past the last row are cleared.  If _codes is not null, _codes[i] is
+  /// the SAS missing value code of the value i ('.', 'A' to 'Z' or '_')
+  /// or 0 if the value is not missing.  Only the numeric columns have
+  /// missing values.
+  void get_validity(const RowBatch &_rows, uint8_t *_validity,
+                    char *_codes = nullptr) const {
+    pimpl->get_validity(_rows, _validity, _codes);
+  }
+  /// Same with an array of _n row pointers.
+  void get_strings(const PBUF *_rows, const size_t _n, SV *_out) const {
+    get_strings(RowBatch{0, _n, _rows}, _out);
+  }
+  void get_numbers(const PBUF *_rows, const size_t _n, NUMBER *_out) const {
+    get_numbers(RowBatch{0, _n, _rows}, _out);
+  }
+  void get_integers(const PBUF *_rows, const size_t _n, INTEGER *_out) const {
+    get_integers(RowBatch{0, _n, _rows}, _out);
+  }
+  void get_epochs(const PBUF *_rows, const size_t _n, EPOCH *_out) const {
+    get_epochs(RowBatch{0, _n, _rows}, _out);
+  }
+  void get_validity(const PBUF *_rows, const size_t _n, uint8_t *_validity,
+                    char *_codes = nullptr) const {
+    get_validity(RowBatch{0, _n, _rows}, _validity, _codes);
+  }
+
   size_t length() const noexcept { return pimpl->length(); }
+  /// Offset of the value in the row, if the formatter gives it.
+  std::optional<size_t> offset() const noexcept { return pimpl->offset(); }
+  Layout layout() const noexcept { return pimpl->layout(); }
 
 private:
   PIMPL pimpl;
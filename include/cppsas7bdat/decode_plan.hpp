@@ -0,0 +1,88 @@
+/**
+ *  \file cppsas7bdat/decode_plan.hpp
+ *
+ *  \brief Decode plan
+ *
+ *  \author Olivia Quinet
+ */
+
+#ifndef _CPP_SAS7BDAT_DECODE_PLAN_HPP_
+#define _CPP_SAS7BDAT_DECODE_PLAN_HPP_
+
+#include <cppsas7bdat/column.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace cppsas7bdat {
+
+/**
+ *  Flat description of how to decode the values of a row, built once per
+ *  file from the columns.
+ *
+ *  The values are grouped by operation (string, 8-byte double, ...) so a
+ *  row is decoded by a few tight loops instead of one virtual call per
+ *  value.  The columns whose formatter has no layout (Column::Op::none)
+ *  are still decoded with their getters.
+ *
+ *  The decoded values are stored by type in the order of Columns, e.g.
+ *  values.numbers[i] is the value of columns().numbers[i].
+ */
+class DecodePlan {
+public:
+  struct Values {
+    std::vector<SV> strings;
+    std::vector<NUMBER> numbers;
+    std::vector<INTEGER> integers;
+    std::vector<DATETIME> datetimes;
+    std::vector<DATE> dates;
+    std::vector<TIME> times;
+  };
+
+  DecodePlan() = default;
+  explicit DecodePlan(const COLUMNS &_columns);
+
+  /// The columns grouped by type.
+  const Columns &columns() const noexcept { return m_columns; }
+
+  /// Values with the right number of entries for each type.
+  Values make_values() const;
+
+  /// Decode all the values of the row _p into _values.
+  void decode(Column::PBUF _p, Values &_values) const;
+
+  /// Decode each row of _rows and call _fct(irow, values).
+  template <typename _Fct>
+  void decode(const RowBatch &_rows, Values &_values, _Fct _fct) const {
+    for (size_t i = 0; i < _rows.size(); ++i) {
+      decode(_rows[i], _values);
+      _fct(_rows.first_row + i, static_cast<const Values &>(_values));
+    }
+  }
+
+  struct Step {
+    uint32_t offset{0};
+    uint32_t length{0};
+    uint32_t index{0}; /**< Index in the values of the same type */
+    Column::Op op{Column::Op::none};
+    Column::Type type{Column::Type::unknown};
+    Endian endian{Endian::unknown};
+  };
+  /// Consecutive steps with the same op and endianness (and length for the
+  /// numbers).
+  struct Group {
+    uint32_t begin{0};
+    uint32_t end{0};
+  };
+
+  const std::vector<Step> &steps() const noexcept { return m_steps; }
+  const std::vector<Group> &groups() const noexcept { return m_groups; }
+
+private:
+  Columns m_columns;
+  std::vector<Step> m_steps;
+  std::vector<Group> m_groups;
+};
+
+} // namespace cppsas7bdat
+
+#endif
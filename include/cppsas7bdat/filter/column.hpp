@@ -22,6 +22,10 @@ struct AcceptAll {
   bool accept([[maybe_unused]] const Column &_column) const noexcept {
     return true;
   }
+
+  bool is_accepted([[maybe_unused]] const std::string &_name) const noexcept {
+    return true;
+  }
 };
 
 struct Include {
@@ -0,0 +1,239 @@
+/**
+ *  \file cppsas7bdat/filter/row.hpp
+ *
+ *  \brief Row filter description
+ *
+ *  \author Olivia Quinet
+ */
+
+#ifndef _CPP_SAS7BDAT_FILTER_ROW_HPP_
+#define _CPP_SAS7BDAT_FILTER_ROW_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <cppsas7bdat/column.hpp>
+#include <cppsas7bdat/row_batch.hpp>
+
+namespace cppsas7bdat {
+
+namespace RowFilter {
+
+/// Condition which cannot be evaluated on the columns, see Where::bind.
+struct BindError {
+  enum class Reason : uint8_t {
+    unknown_column, /**< The column is not found */
+    type_mismatch   /**< A string for a number column or the reverse */
+  };
+  std::string column;
+  Reason reason;
+};
+
+struct AcceptAll {
+  bool accept([[maybe_unused]] Column::PBUF _p) const noexcept { return true; }
+};
+
+/**
+ *  Rows for which all the conditions hold, e.g.
+ *
+ *    RowFilter::Where().equal("STATE", "CA").greater_equal("YEAR", 2015)
+ *
+ *  The conditions are evaluated in order on the raw rows, only the
+ *  referenced columns being decoded, and only for the rows accepted by the
+ *  previous conditions.  The string columns are compared with the trimmed
+ *  strings, the other columns with get_number, i.e. the SAS value for the
+ *  dates and times.  A missing number fails every condition.
+ */
+class Where {
+public:
+  enum class Op : uint8_t { eq, ne, lt, le, gt, ge, in, between };
+
+  Where &equal(std::string _column, const NUMBER _x) {
+    return add_numbers(std::move(_column), Op::eq, {_x});
+  }
+  Where &equal(std::string _column, std::string _x) {
+    return add_strings(std::move(_column), Op::eq, {std::move(_x)});
+  }
+  Where &not_equal(std::string _column, const NUMBER _x) {
+    return add_numbers(std::move(_column), Op::ne, {_x});
+  }
+  Where &not_equal(std::string _column, std::string _x) {
+    return add_strings(std::move(_column), Op::ne, {std::move(_x)});
+  }
+  Where &less(std::string _column, const NUMBER _x) {
+    return add_numbers(std::move(_column), Op::lt, {_x});
+  }
+  Where &less(std::string _column, std::string _x) {
+    return add_strings(std::move(_column), Op::lt, {std::move(_x)});
+  }
+  Where &less_equal(std::string _column, const NUMBER _x) {
+    return add_numbers(std::move(_column), Op::le, {_x});
+  }
+  Where &less_equal(std::string _column, std::string _x) {
+    return add_strings(std::move(_column), Op::le, {std::move(_x)});
+  }
+  Where &greater(std::string _column, const NUMBER _x) {
+    return add_numbers(std::move(_column), Op::gt, {_x});
+  }
+  Where &greater(std::string _column, std::string _x) {
+    return add_strings(std::move(_column), Op::gt, {std::move(_x)});
+  }
+  Where &greater_equal(std::string _column, const NUMBER _x) {
+    return add_numbers(std::move(_column), Op::ge, {_x});
+  }
+  Where &greater_equal(std::string _column, std::string _x) {
+    return add_strings(std::move(_column), Op::ge, {std::move(_x)});
+  }
+  /// The value is one of _xs.
+  Where &in(std::string _column, std::vector<NUMBER> _xs) {
+    return add_numbers(std::move(_column), Op::in, std::move(_xs));
+  }
+  Where &in(std::string _column, std::vector<std::string> _xs) {
+    return add_strings(std::move(_column), Op::in, std::move(_xs));
+  }
+  /// _low <= value <= _high
+  Where &between(std::string _column, const NUMBER _low, const NUMBER _high) {
+    return add_numbers(std::move(_column), Op::between, {_low, _high});
+  }
+  Where &between(std::string _column, std::string _low, std::string _high) {
+    return add_strings(std::move(_column), Op::between,
+                       {std::move(_low), std::move(_high)});
+  }
+
+  /// Find the columns of the conditions in _columns.  Return the first
+  /// condition whose column is not found or whose values are not of the
+  /// column's type, i.e. strings for the string columns and numbers for the
+  /// others, if any.
+  std::optional<BindError> bind(const COLUMNS &_columns) {
+    for (auto &condition : conditions) {
+      const auto it = std::find_if(
+          _columns.begin(), _columns.end(),
+          [&](const Column &_c) { return _c.name == condition.name; });
+      if (it == _columns.end())
+        return BindError{condition.name, BindError::Reason::unknown_column};
+      if (condition.strings.empty() == (it->type == Column::Type::string))
+        return BindError{condition.name, BindError::Reason::type_mismatch};
+      condition.column.emplace(*it);
+    }
+    return {};
+  }
+
+  bool accept(Column::PBUF _p) const {
+    return std::all_of(conditions.begin(), conditions.end(),
+                       [_p](const Condition &_c) { return _c.accept(_p); });
+  }
+
+  /// Store the indices of the rows of _rows accepted in _selected and
+  /// return their number.  Each condition is evaluated on all the rows
+  /// still selected at once, see Column::get_numbers.  The scratch
+  /// vectors are reused from batch to batch: not thread-safe.
+  size_t select(const RowBatch &_rows, size_t *_selected) const {
+    size_t count = _rows.count;
+    for (size_t i = 0; i < count; ++i)
+      _selected[i] = i;
+    bool all = true;
+    for (const auto &condition : conditions) {
+      if (count == 0)
+        break;
+      RowBatch batch = _rows;
+      if (!all) {
+        rows.resize(count);
+        for (size_t i = 0; i < count; ++i)
+          rows[i] = _rows[_selected[i]];
+        batch = RowBatch{_rows.first_row, count, rows.data()};
+      }
+      size_t k = 0;
+      if (condition.is_string()) {
+        strings.resize(count);
+        condition.column->get_strings(batch, strings.data());
+        for (size_t i = 0; i < count; ++i)
+          if (condition.test(strings[i]))
+            _selected[k++] = _selected[i];
+      } else {
+        numbers.resize(count);
+        condition.column->get_numbers(batch, numbers.data());
+        for (size_t i = 0; i < count; ++i)
+          if (condition.test(numbers[i]))
+            _selected[k++] = _selected[i];
+      }
+      all = all && k == count;
+      count = k;
+    }
+    return count;
+  }
+
+private:
+  struct Condition {
+    std::string name;
+    Op op;
+    std::vector<NUMBER> numbers;
+    std::vector<std::string> strings;
+    std::optional<Column> column;
+
+    bool is_string() const noexcept {
+      return column->type == Column::Type::string;
+    }
+
+    template <typename _Tp, typename _Values>
+    bool test(const _Tp &_x, const _Values &_values) const {
+      switch (op) {
+      case Op::eq:
+        return _x == _values[0];
+      case Op::ne:
+        return _x != _values[0];
+      case Op::lt:
+        return _x < _values[0];
+      case Op::le:
+        return _x <= _values[0];
+      case Op::gt:
+        return _x > _values[0];
+      case Op::ge:
+        return _x >= _values[0];
+      case Op::in:
+        return std::find(_values.begin(), _values.end(), _x) != _values.end();
+      case Op::between:
+        return _values[0] <= _x && _x <= _values[1];
+      }
+      return false;
+    }
+
+    bool test(const NUMBER _x) const {
+      return !std::isnan(_x) && !numbers.empty() && test(_x, numbers);
+    }
+    bool test(const SV _x) const {
+      return !strings.empty() && test(_x, strings);
+    }
+
+    bool accept(Column::PBUF _p) const {
+      if (is_string())
+        return test(column->get_string(_p));
+      return test(column->get_number(_p));
+    }
+  };
+
+  Where &add_numbers(std::string _column, const Op _op,
+                     std::vector<NUMBER> _xs) {
+    conditions.push_back({std::move(_column), _op, std::move(_xs), {}, {}});
+    return *this;
+  }
+  Where &add_strings(std::string _column, const Op _op,
+                     std::vector<std::string> _xs) {
+    conditions.push_back({std::move(_column), _op, {}, std::move(_xs), {}});
+    return *this;
+  }
+
+  std::vector<Condition> conditions;
+  /// Scratch of select: the selected rows and their decoded values.
+  mutable std::vector<Column::PBUF> rows;
+  mutable std::vector<NUMBER> numbers;
+  mutable std::vector<SV> strings;
+};
+
+} // namespace RowFilter
+
+} // namespace cppsas7bdat
+
+#endif
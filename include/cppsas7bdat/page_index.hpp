@@ -0,0 +1,66 @@
+/**
+ *  \file cppsas7bdat/page_index.hpp
+ *
+ *  \brief Page index
+ *
+ *  \author Olivia Quinet
+ */
+
+#ifndef _CPP_SAS7BDAT_PAGE_INDEX_HPP_
+#define _CPP_SAS7BDAT_PAGE_INDEX_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace cppsas7bdat {
+
+/**
+ *  Location and row range of each page of a file.  It can be saved into a
+ *  small sidecar file and reloaded as long as the file has not changed,
+ *  i.e. same size and modification time.
+ */
+struct PageIndex {
+  struct Page {
+    uint64_t offset{0};    /**< Offset of the page in the file */
+    uint16_t type{0};      /**< PAGE_*_TYPE */
+    uint64_t first_row{0}; /**< Global index of the first row of the page */
+    uint64_t row_count{0}; /**< Number of rows on the page */
+
+    bool operator==(const Page &) const = default;
+  };
+
+  /// Page-aligned range of rows [first_row, end_row).
+  struct Partition {
+    size_t first_page{0};
+    size_t end_page{0};
+    size_t first_row{0};
+    size_t end_row{0};
+
+    bool operator==(const Partition &) const = default;
+  };
+
+  uint64_t file_size{0};
+  int64_t file_mtime{0};
+  std::vector<Page> pages;
+
+  bool empty() const noexcept { return pages.empty(); }
+
+  /// Return the index of the page holding the row _row or pages.size().
+  size_t find(const size_t _row) const noexcept;
+
+  /// Split the pages into at most _count partitions with about the same
+  /// number of rows.  The partitions are empty if the index is empty.
+  std::vector<Partition> partitions(const size_t _count) const;
+
+  /// Save the index for the file _pcszfilename into _pcszsidecar.
+  void save(const char *_pcszsidecar, const char *_pcszfilename) const;
+  /// Load the index from _pcszsidecar if it matches the file _pcszfilename.
+  static std::optional<PageIndex> load(const char *_pcszsidecar,
+                                       const char *_pcszfilename);
+};
+
+} // namespace cppsas7bdat
+
+#endif
@@ -10,10 +10,17 @@
 #define _CPP_SAS7BDAT_READER_HPP_
 
 #include <cppsas7bdat/filter/column.hpp>
+#include <cppsas7bdat/filter/row.hpp>
 #include <cppsas7bdat/column.hpp>
+#include <cppsas7bdat/page_index.hpp>
 #include <cppsas7bdat/properties.hpp>
+#include <cppsas7bdat/row_batch.hpp>
+#include <cppsas7bdat/sample.hpp>
 #include <cppsas7bdat/version.hpp>
 #include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
 
 namespace cppsas7bdat {
 
@@ -24,6 +31,27 @@ private:
 
     virtual bool eof() = 0;
     virtual bool read_bytes(void *_p, const size_t _length) = 0;
+    /// Return a view on the next _length bytes without copying them or
+    /// nullptr if the data source cannot provide such view.
+    virtual const void *view_bytes(const size_t _length) = 0;
+    /// Called once the header has been read, i.e. before the first page.
+    virtual void set_header(const Properties::Header &_header) = 0;
+
+    /// Optional random access: the following methods are only valid if
+    /// is_seekable() returns true.
+    virtual bool is_seekable() const noexcept = 0;
+    virtual size_t size() = 0;
+    virtual size_t tell() = 0;
+    virtual bool seek(const size_t _position) = 0;
+    /// Read _length bytes at _position without moving the current position.
+    /// Emulated with tell/seek/read/seek if the data source does not
+    /// provide it: a data source whose views do not survive a seek (e.g.
+    /// a ring of buffers) must provide it.
+    virtual bool read_bytes_at(void *_p, const size_t _length,
+                               const size_t _position) = 0;
+
+    /// A trusted source skips the bounds checks when decoding the rows.
+    virtual bool is_trusted() const noexcept = 0;
   };
 
   template <typename _Source>
@@ -37,6 +65,67 @@ private:
       return source.read_bytes(_p, _length);
     }
 
+    const void *view_bytes(const size_t _length) final {
+      if constexpr (requires { source.view_bytes(_length); })
+        return source.view_bytes(_length);
+      else
+        return nullptr;
+    }
+
+    void set_header(const Properties::Header &_header) final {
+      if constexpr (requires { source.set_header(_header); })
+        source.set_header(_header);
+    }
+
+    static constexpr bool seekable = requires(_Source &_s, size_t _position) {
+      _s.size();
+      _s.tell();
+      _s.seek(_position);
+    };
+
+    bool is_seekable() const noexcept final { return seekable; }
+
+    size_t size() final {
+      if constexpr (seekable)
+        return source.size();
+      else
+        return 0;
+    }
+
+    size_t tell() final {
+      if constexpr (seekable)
+        return source.tell();
+      else
+        return 0;
+    }
+
+    bool seek(const size_t _position) final {
+      if constexpr (seekable)
+        return source.seek(_position);
+      else
+        return false;
+    }
+
+    bool read_bytes_at(void *_p, const size_t _length,
+                       const size_t _position) final {
+      if constexpr (requires { source.read_bytes_at(_p, _length, _position); })
+        return source.read_bytes_at(_p, _length, _position);
+      else if constexpr (seekable) {
+        const auto position = source.tell();
+        const bool r = source.seek(_position) && source.read_bytes(_p, _length);
+        // The current position must be restored even if the read failed.
+        return source.seek(position) && r;
+      } else
+        return false;
+    }
+
+    bool is_trusted() const noexcept final {
+      if constexpr (requires { source.is_trusted(); })
+        return source.is_trusted();
+      else
+        return false;
+    }
+
     _Source source;
   };
 
@@ -45,6 +134,8 @@ private:
 
     virtual void set_properties(const Properties &_properties) = 0;
     virtual void push_row(const size_t _row_index, Column::PBUF _p) = 0;
+    // Optional: the rows of a whole page at once, see RowBatch.
+    virtual void push_rows(const RowBatch &_rows) = 0;
     virtual void end_of_data() = 0;
   };
 
@@ -61,6 +152,15 @@ private:
       dataset.push_row(_row_index, _p);
     }
 
+    void push_rows(const RowBatch &_rows) final {
+      if constexpr (requires { dataset.push_rows(_rows); }) {
+        dataset.push_rows(_rows);
+      } else {
+        for (size_t i = 0; i < _rows.size(); ++i)
+          dataset.push_row(_rows.first_row + i, _rows[i]);
+      }
+    }
+
     void end_of_data() final { dataset.end_of_data(); }
 
   private:
@@ -71,6 +171,8 @@ private:
     virtual ~FilterConcept();
 
     virtual bool accept(const Column &_column) const = 0;
+    /// Decision from the name only, if the filter provides is_accepted.
+    virtual std::optional<bool> accept(std::string_view _name) const = 0;
   };
 
   template <typename _Filter> struct FilterModel : public FilterConcept {
@@ -80,17 +182,67 @@ private:
     bool accept(const Column &_column) const final {
       return filter.accept(_column);
     }
+    std::optional<bool> accept(std::string_view _name) const final {
+      if constexpr (requires { filter.is_accepted(std::string(_name)); })
+        return filter.is_accepted(std::string(_name));
+      else
+        return {};
+    }
 
   private:
     _Filter filter;
   };
 
+  struct RowFilterConcept {
+    virtual ~RowFilterConcept();
+
+    /// Called once with the columns of the dataset.  Return the first
+    /// condition which cannot be evaluated on them, if any.
+    virtual std::optional<RowFilter::BindError>
+    bind(const COLUMNS &_columns) = 0;
+    virtual bool accept(Column::PBUF _p) const = 0;
+    /// Store the indices of the rows of _rows accepted in _selected and
+    /// return their number.
+    virtual size_t select(const RowBatch &_rows, size_t *_selected) const = 0;
+  };
+
+  template <typename _RowFilter>
+  struct RowFilterModel : public RowFilterConcept {
+    template <typename _Tp>
+    RowFilterModel(_Tp &&_filter) : filter(std::forward<_Tp>(_filter)) {}
+
+    std::optional<RowFilter::BindError> bind(const COLUMNS &_columns) final {
+      if constexpr (requires { filter.bind(_columns); })
+        return filter.bind(_columns);
+      else
+        return {};
+    }
+
+    bool accept(Column::PBUF _p) const final { return filter.accept(_p); }
+
+    size_t select(const RowBatch &_rows, size_t *_selected) const final {
+      if constexpr (requires { filter.select(_rows, _selected); }) {
+        return filter.select(_rows, _selected);
+      } else {
+        size_t n = 0;
+        for (size_t i = 0; i < _rows.size(); ++i)
+          if (filter.accept(_rows[i]))
+            _selected[n++] = i;
+        return n;
+      }
+    }
+
+  private:
+    _RowFilter filter;
+  };
+
 public:
   class impl;
   using PIMPL = std::unique_ptr<impl>;
   using PSOURCE = std::unique_ptr<DataSourceConcept>;
   using PSINK = std::unique_ptr<DatasetSinkConcept>;
   using PFILTER = std::unique_ptr<FilterConcept>;
+  using PROWFILTER = std::unique_ptr<RowFilterConcept>;
 
   template <typename _Source> static PSOURCE build_source(_Source &&_source) {
     return std::make_unique<DataSourceModel<_Source>>(
@@ -104,12 +256,19 @@ public:
     return std::make_unique<FilterModel<_Filter>>(
         std::forward<_Filter>(_filter));
   }
+  template <typename _RowFilter>
+  static PROWFILTER build_row_filter(_RowFilter &&_filter) {
+    // The row filter is kept while reading: it is copied, not referenced.
+    return std::make_unique<RowFilterModel<std::decay_t<_RowFilter>>>(
+        std::forward<_RowFilter>(_filter));
+  }
 
 private:
   PIMPL m_pimpl;
 
 protected:
   Reader(PSOURCE &&_source, PSINK &&_sink, PFILTER &&_filter);
+  explicit Reader(PIMPL &&_pimpl) noexcept;
 
 public:
   template <typename _Source, typename _Sink,
@@ -129,10 +288,48 @@ public:
   void end_of_data();
 
   bool skip(const size_t _nrows);
+  /// Move to the row _row, see PageIndex.
+  bool seek(const size_t _row);
+
+  /// Return the page index, built on first use.
+  const PageIndex &page_index();
+  /// Use a page index loaded from a sidecar file, see PageIndex::load.
+  void set_page_index(PageIndex _index);
+
+  /// Only push to the sink the subsequent rows accepted by _filter, see
+  /// RowFilter::Where.  The columns referenced by _filter must be selected
+  /// by the column filter.  The rejected rows are read but never pushed;
+  /// the partitions inherit the row filter.
+  template <typename _RowFilter> void set_row_filter(_RowFilter &&_filter) {
+    set_row_filter(build_row_filter(std::forward<_RowFilter>(_filter)));
+  }
+  void set_row_filter(PROWFILTER &&_filter);
+
+  /// Split the rows into at most _count page-aligned partitions.
+  std::vector<PageIndex::Partition> partitions(const size_t _count);
+  /// Return a reader of the rows of _partition from another data source on
+  /// the same file.  It shares the properties and the page index, i.e. the
+  /// header and the metadata are not read again, and current_row_index()
+  /// returns the global row index.
+  template <typename _Source, typename _Sink>
+  Reader partition(const PageIndex::Partition &_partition, _Source &&_source,
+                   _Sink &&_sink) {
+    return partition(_partition, build_source(std::forward<_Source>(_source)),
+                     build_sink(std::forward<_Sink>(_sink)));
+  }
+  Reader partition(const PageIndex::Partition &_partition, PSOURCE &&_source,
+                   PSINK &&_sink);
 
   void read_all();
+  /// Decode the pages with _nthreads threads.  The rows are still pushed to
+  /// the sink in order, from the calling thread.
+  void read_all(const size_t _nthreads);
   bool read_row();
   bool read_rows(const size_t _chunk_size);
+  /// Push the rows _rows to the sink, then send end_of_data, see Sample.
+  /// The rows must be sorted.  Only the pages holding the rows are read: a
+  /// seekable data source moves directly to them with the page index.
+  bool read_sample(const std::vector<size_t> &_rows);
 
   Column::PBUF read_row_no_sink();
 
@@ -0,0 +1,43 @@
+/**
+ *  \file cppsas7bdat/row_batch.hpp
+ *
+ *  \brief Batch of rows
+ *
+ *  \author Olivia Quinet
+ */
+
+#ifndef _CPP_SAS7BDAT_ROW_BATCH_HPP_
+#define _CPP_SAS7BDAT_ROW_BATCH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cppsas7bdat {
+
+/**
+ *  Consecutive rows pushed at once to a sink, usually the rows of a page.
+ *
+ *  The rows are stored contiguously: base + i * stride.  The compressed
+ *  rows of a page are decompressed together in an arena; the rows of an
+ *  uncompressed data page are read in place.  Alternatively, the row
+ *  pointers can be given in rows.  The rows are only valid during the call
+ *  to push_rows.
+ */
+struct RowBatch {
+  size_t first_row{0};               /**< Global index of the first row */
+  size_t count{0};                   /**< Number of rows */
+  const void *const *rows{nullptr};  /**< Row pointers or nullptr */
+  const uint8_t *base{nullptr};      /**< First row if rows is nullptr */
+  size_t stride{0};                  /**< Distance between two rows */
+
+  size_t size() const noexcept { return count; }
+  bool empty() const noexcept { return count == 0; }
+
+  const void *operator[](const size_t _i) const noexcept {
+    return rows ? rows[_i] : base + _i * stride;
+  }
+};
+
+} // namespace cppsas7bdat
+
+#endif
@@ -0,0 +1,38 @@
+/**
+ *  \file cppsas7bdat/sample.hpp
+ *
+ *  \brief Row sampling
+ *
+ *  \author Olivia Quinet
+ */
+
+#ifndef _CPP_SAS7BDAT_SAMPLE_HPP_
+#define _CPP_SAS7BDAT_SAMPLE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cppsas7bdat {
+
+/**
+ *  Choice of the rows of a sample, sorted and distinct, to be read with
+ *  Reader::read_sample.
+ */
+namespace Sample {
+
+/// Every _step-th row from the row _first: _first, _first + _step, ...
+std::vector<size_t> systematic(const size_t _row_count, const size_t _step,
+                               const size_t _first = 0);
+
+/// _count rows drawn uniformly without replacement, or all the rows if
+/// _count >= _row_count.  The rows only depend on _seed, i.e. not on the
+/// platform or the standard library.
+std::vector<size_t> random(const size_t _row_count, const size_t _count,
+                           const uint64_t _seed);
+
+} // namespace Sample
+
+} // namespace cppsas7bdat
+
+#endif
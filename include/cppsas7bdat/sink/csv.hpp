@@ -10,23 +10,32 @@
 #define _CPP_SAS7BDAT_SINK_CSV_HPP_
 
 #include <cppsas7bdat/column.hpp>
+#include <cppsas7bdat/transcoder.hpp>
 #include <fmt/core.h>
 #include <fmt/ostream.h>
 #include <fstream>
 #include <iostream>
+#include <optional>
+#include <string>
 
 namespace cppsas7bdat {
 namespace datasink {
 namespace detail {
 struct csv {
   std::ostream &os;
+  const bool utf8; /**< Convert the strings to UTF-8 */
 
-  explicit csv(std::ostream &_os) noexcept : os(_os) {}
+  explicit csv(std::ostream &_os, const bool _utf8 = false) noexcept
+      : os(_os), utf8(_utf8) {}
 
   COLUMNS columns;
+  std::optional<Transcoder> transcoder;
+  std::string buffer;
 
   void set_properties(const Properties &_properties) {
     columns = COLUMNS(_properties /*.metadata*/.columns);
+    if (utf8)
+      transcoder.emplace(_properties.encoding);
     bool first = true;
     for (const auto &column : columns) {
       if (first)
@@ -71,7 +80,14 @@ struct csv {
 
   void end_of_data() const noexcept {}
 
-  void print(const SV &_x) { fmt::print(os, "\"{}\"", _x); }
+  void print(const SV &_x) {
+    if (transcoder && transcoder->is_supported()) {
+      buffer.clear();
+      transcoder->append(_x, buffer);
+      fmt::print(os, "\"{}\"", buffer);
+    } else
+      fmt::print(os, "\"{}\"", _x);
+  }
   void print(const NUMBER _x) {
     if (!std::isnan(_x))
       fmt::print(os, "{}", _x);
@@ -89,16 +105,18 @@ struct _ofstream {
 };
 
 struct csv_ofstream : public _ofstream, public csv {
-  explicit csv_ofstream(const char *_pcszfilename)
-      : _ofstream(_pcszfilename), csv(ofs) {}
+  explicit csv_ofstream(const char *_pcszfilename, const bool _utf8 = false)
+      : _ofstream(_pcszfilename), csv(ofs, _utf8) {}
 };
 
 } // namespace detail
 
 struct _csv_factory {
-  auto operator()(std::ostream &_os) const noexcept { return detail::csv(_os); }
-  auto operator()(const char *_pcszfilename) const {
-    return detail::csv_ofstream(_pcszfilename);
+  auto operator()(std::ostream &_os, const bool _utf8 = false) const noexcept {
+    return detail::csv(_os, _utf8);
+  }
+  auto operator()(const char *_pcszfilename, const bool _utf8 = false) const {
+    return detail::csv_ofstream(_pcszfilename, _utf8);
   }
 } csv;
 
@@ -0,0 +1,44 @@
+/**
+ *  \file cppsas7bdat/sink/null_plan.hpp
+ *
+ *  \brief NULL datasink decoding the rows with a DecodePlan
+ *
+ *  \author Olivia Quinet
+ */
+
+#ifndef _CPP_SAS7BDAT_SINK_NULL_PLAN_HPP_
+#define _CPP_SAS7BDAT_SINK_NULL_PLAN_HPP_
+
+#include <cppsas7bdat/decode_plan.hpp>
+#include <cppsas7bdat/properties.hpp>
+
+namespace cppsas7bdat {
+namespace datasink {
+/**
+ *  Same as null but all the values of a row are decoded at once with a
+ *  DecodePlan instead of one Column getter per value.
+ */
+struct null_plan {
+  DecodePlan plan;
+  DecodePlan::Values values;
+
+  void set_properties(const Properties &_properties) {
+    plan = DecodePlan(_properties /*.metadata*/.columns);
+    values = plan.make_values();
+  }
+
+  void push_row([[maybe_unused]] const size_t _irow, Column::PBUF _p) {
+    plan.decode(_p, values);
+  }
+
+  void push_rows(const RowBatch &_rows) {
+    plan.decode(_rows, values,
+                [](const size_t, const DecodePlan::Values &) noexcept {});
+  }
+
+  void end_of_data() const noexcept {}
+};
+} // namespace datasink
+} // namespace cppsas7bdat
+
+#endif
@@ -16,6 +16,7 @@ namespace datasource {
 
 struct ifstream {
   std::ifstream is;
+  size_t length{0};
 
   explicit ifstream(const char *_pcszfilename);
 
@@ -26,6 +27,18 @@ struct ifstream {
     // Did we manage to read the requested data?
     return is.good();
   }
+
+  size_t size() const noexcept { return length; }
+  size_t tell() {
+    const auto position = is.tellg();
+    // tellg fails once the end of the file has been reached
+    return position < 0 ? length : static_cast<size_t>(position);
+  }
+  bool seek(const size_t _position) {
+    is.clear();
+    is.seekg(static_cast<std::streamoff>(_position));
+    return !is.fail();
+  }
 };
 
 } // namespace datasource
@@ -0,0 +1,83 @@
+/**
+ *  \file cppsas7bdat/source/mmap.hpp
+ *
+ *  \brief Memory-mapped datasource
+ *
+ *  \author Olivia Quinet
+ */
+
+#ifndef _CPP_SAS7BDAT_SOURCE_MMAP_HPP_
+#define _CPP_SAS7BDAT_SOURCE_MMAP_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace cppsas7bdat {
+namespace datasource {
+
+/**
+ *  The whole file is mapped in memory and the pages are directly read
+ *  from the mapping without any copy (see view_bytes).
+ */
+struct mmap {
+  std::shared_ptr<const uint8_t> data; /**< Unmapped with the last copy */
+  size_t length{0};
+  size_t position{0};
+  size_t advised{0}; /**< End of the range already advised with WILLNEED */
+
+  /// Size of the range advised ahead of the current position
+  static constexpr size_t advise_length{8 * 1024 * 1024};
+
+  explicit mmap(const char *_pcszfilename);
+
+  bool eof() const noexcept { return position >= length; }
+
+  bool read_bytes(void *_p, const size_t _length) {
+    const size_t n = copy(_p, _length, position);
+    position += n;
+    // Did we manage to read the requested data?
+    return n == _length;
+  }
+
+  const void *view_bytes(const size_t _length) {
+    if (_length > length - std::min(position, length))
+      return nullptr;
+    const auto p = data.get() + position;
+    position += _length;
+    if (position > advised)
+      advise();
+    return p;
+  }
+
+  size_t size() const noexcept { return length; }
+  size_t tell() const noexcept { return position; }
+  bool seek(const size_t _position) noexcept {
+    position = _position;
+    // The range ahead of the new position is advised, even backward.
+    advised = position;
+    advise();
+    return true;
+  }
+  bool read_bytes_at(void *_p, const size_t _length,
+                     const size_t _position) const noexcept {
+    return copy(_p, _length, _position) == _length;
+  }
+
+private:
+  size_t copy(void *_p, const size_t _length,
+              const size_t _position) const noexcept {
+    const size_t n = std::min(_length, length - std::min(_position, length));
+    if (n)
+      std::memcpy(_p, data.get() + _position, n);
+    return n;
+  }
+
+  void advise() noexcept;
+};
+
+} // namespace datasource
+} // namespace cppsas7bdat
+
+#endif
@@ -0,0 +1,286 @@
+/**
+ *  \file cppsas7bdat/source/prefetch.hpp
+ *
+ *  \brief Prefetching datasource
+ *
+ *  \author Olivia Quinet
+ */
+
+#ifndef _CPP_SAS7BDAT_SOURCE_PREFETCH_HPP_
+#define _CPP_SAS7BDAT_SOURCE_PREFETCH_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cppsas7bdat/properties.hpp>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cppsas7bdat {
+namespace datasource {
+
+/**
+ *  Wrap another datasource and read the pages ahead on a background
+ *  thread into a ring of page buffers.
+ *
+ *  The header is read synchronously from the wrapped datasource.  Once
+ *  the page length is known (see set_header), a thread reads up to
+ *  `depth` pages ahead while the pages already read are decoded.
+ */
+template <typename _Source> struct prefetch {
+  struct statistics {
+    size_t pages{0};  /**< Number of pages read from the ring */
+    size_t waits{0};  /**< Number of times the decoder waited for a page */
+    std::chrono::nanoseconds wait_time{0}; /**< Total waiting time */
+  };
+
+  explicit prefetch(_Source &&_source, const size_t _depth = 4)
+      : m(std::make_unique<state>(std::move(_source), _depth)),
+        stats(std::make_shared<statistics>()) {}
+
+  prefetch(prefetch &&) noexcept = default;
+  prefetch &operator=(prefetch &&) = delete;
+  ~prefetch() {
+    if (m)
+      m->stop();
+  }
+
+  bool eof() {
+    if (!m->thread.joinable())
+      return m->source.eof();
+    return !m->next_slot(*stats) && m->source_eof;
+  }
+
+  bool read_bytes(void *_p, size_t _length) {
+    if (!m->thread.joinable())
+      return m->source.read_bytes(_p, _length);
+    auto p = static_cast<uint8_t *>(_p);
+    while (_length) {
+      if (!m->next_slot(*stats))
+        return false;
+      auto &slot = m->slots[m->consumer % m->slots.size()];
+      const size_t n = std::min(_length, slot.size - m->offset);
+      std::memcpy(p, slot.buffer.get() + m->offset, n);
+      m->offset += n;
+      p += n;
+      _length -= n;
+    }
+    return true;
+  }
+
+  const void *view_bytes(const size_t _length) {
+    if (!m->thread.joinable()) {
+      if constexpr (requires { m->source.view_bytes(_length); })
+        return m->source.view_bytes(_length);
+      else
+        return nullptr;
+    }
+    // Only full pages are served as views, the rest is copied.
+    if (!m->next_slot(*stats) || m->offset != 0)
+      return nullptr;
+    auto &slot = m->slots[m->consumer % m->slots.size()];
+    if (slot.size != _length)
+      return nullptr;
+    // The slot is released on the next call, i.e. once the view has been
+    // replaced by the next page.
+    m->offset = _length;
+    return slot.buffer.get();
+  }
+
+  void set_header(const Properties::Header &_header) {
+    if constexpr (requires { m->source.set_header(_header); })
+      m->source.set_header(_header);
+    if (_header.page_length && !m->thread.joinable())
+      m->start(_header.page_length);
+  }
+
+  size_t size()
+    requires requires(_Source &_s) { _s.size(); }
+  {
+    return m->source.size();
+  }
+
+  size_t tell()
+    requires requires(_Source &_s) { _s.tell(); }
+  {
+    if (!m->thread.joinable())
+      return m->source.tell();
+    return m->start_position + m->consumer * m->page_length + m->offset;
+  }
+
+  /// Positional read from the wrapped datasource: the thread is paused
+  /// but the pages read ahead, and the views on them, are kept.
+  bool read_bytes_at(void *_p, const size_t _length, const size_t _position)
+    requires(requires(_Source &_s) {
+      _s.read_bytes_at(_p, _length, _position);
+    } || requires(_Source &_s) {
+      _s.tell();
+      _s.seek(_position);
+    })
+  {
+    std::lock_guard lock(m->source_mutex);
+    if constexpr (requires {
+                    m->source.read_bytes_at(_p, _length, _position);
+                  }) {
+      return m->source.read_bytes_at(_p, _length, _position);
+    } else {
+      const auto position = m->source.tell();
+      const bool r =
+          m->source.seek(_position) && m->source.read_bytes(_p, _length);
+      return m->source.seek(position) && r;
+    }
+  }
+
+  /// The pages read ahead are dropped and the thread restarts from the
+  /// new position.  A view on the current page must be copied first.
+  bool seek(const size_t _position)
+    requires requires(_Source &_s) { _s.seek(_position); }
+  {
+    if (!m->thread.joinable())
+      return m->source.seek(_position);
+    m->stop();
+    if (!m->source.seek(_position))
+      return false;
+    m->restart(_position);
+    return true;
+  }
+
+  std::shared_ptr<const statistics> get_statistics() const noexcept {
+    return stats;
+  }
+
+private:
+  struct state {
+    struct slot_t {
+      std::unique_ptr<uint8_t[]> buffer;
+      size_t size{0};
+    };
+
+    _Source source;
+    size_t page_length{0};
+    size_t start_position{0}; /**< Position of the first page read ahead */
+    std::vector<slot_t> slots;
+    std::thread thread;
+    std::mutex source_mutex; /**< Held by the thread while it reads */
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t producer{0}; /**< Number of pages read by the thread */
+    size_t consumer{0}; /**< Index of the page being consumed */
+    size_t offset{0};   /**< Offset in the page being consumed */
+    bool done{false};
+    bool source_eof{false};
+    bool stopping{false};
+    std::exception_ptr error;
+
+    state(_Source &&_source, const size_t _depth)
+        : source(std::move(_source)), slots(std::max<size_t>(_depth, 1) + 1) {}
+
+    void start(const size_t _page_length) {
+      page_length = _page_length;
+      for (auto &slot : slots)
+        slot.buffer = std::make_unique<uint8_t[]>(_page_length);
+      if constexpr (requires { source.tell(); })
+        start_position = source.tell();
+      thread = std::thread([this]() { run(); });
+    }
+
+    void restart(const size_t _position) {
+      producer = consumer = offset = 0;
+      done = source_eof = stopping = false;
+      error = nullptr;
+      start_position = _position;
+      thread = std::thread([this]() { run(); });
+    }
+
+    void stop() {
+      if (!thread.joinable())
+        return;
+      {
+        std::lock_guard lock(mutex);
+        stopping = true;
+      }
+      cv.notify_all();
+      thread.join();
+    }
+
+    void run() {
+      try {
+        for (;;) {
+          {
+            // The slot of the page being consumed must not be overwritten.
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [&]() {
+              return stopping || producer < consumer + slots.size();
+            });
+            if (stopping)
+              return;
+          }
+          auto &slot = slots[producer % slots.size()];
+          std::unique_lock source_lock(source_mutex);
+          if (!source.read_bytes(slot.buffer.get(), page_length)) {
+            const bool is_eof = source.eof();
+            source_lock.unlock();
+            std::lock_guard lock(mutex);
+            source_eof = is_eof;
+            done = true;
+            break;
+          }
+          source_lock.unlock();
+          {
+            std::lock_guard lock(mutex);
+            slot.size = page_length;
+            ++producer;
+          }
+          cv.notify_all();
+        }
+      } catch (...) {
+        std::lock_guard lock(mutex);
+        error = std::current_exception();
+        done = true;
+      }
+      cv.notify_all();
+    }
+
+    /// Make sure the page being consumed still has some data.  Return
+    /// false if no more data is available.
+    bool next_slot(statistics &_stats) {
+      std::unique_lock lock(mutex);
+      if (consumer < producer) {
+        if (offset < slots[consumer % slots.size()].size) {
+          _stats.pages = consumer + 1;
+          return true;
+        }
+        // The current page has been consumed: release its slot.
+        ++consumer;
+        offset = 0;
+        cv.notify_all();
+      }
+      if (consumer >= producer && !done) {
+        const auto t0 = std::chrono::steady_clock::now();
+        cv.wait(lock, [&]() { return consumer < producer || done; });
+        ++_stats.waits;
+        _stats.wait_time += std::chrono::steady_clock::now() - t0;
+      }
+      if (error)
+        std::rethrow_exception(std::exchange(error, nullptr));
+      if (consumer >= producer)
+        return false;
+      _stats.pages = consumer + 1;
+      return true;
+    }
+  };
+
+  std::unique_ptr<state> m;
+  std::shared_ptr<statistics> stats;
+};
+
+} // namespace datasource
+} // namespace cppsas7bdat
+
+#endif
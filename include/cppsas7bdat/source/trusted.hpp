@@ -0,0 +1,37 @@
+/**
+ *  \file cppsas7bdat/source/trusted.hpp
+ *
+ *  \brief Trusted datasource
+ *
+ *  \author Olivia Quinet
+ */
+
+#ifndef _CPP_SAS7BDAT_SOURCE_TRUSTED_HPP_
+#define _CPP_SAS7BDAT_SOURCE_TRUSTED_HPP_
+
+#include <utility>
+
+namespace cppsas7bdat {
+namespace datasource {
+
+/**
+ *  Wrap another datasource whose files are known to be valid, e.g. written
+ *  by SAS and checked once.
+ *
+ *  The rows are then decoded without checking the row offsets against the
+ *  page nor the decompressed rows against the row length.  The header,
+ *  the metadata and the page headers are still validated.  A corrupted
+ *  file read through this datasource leads to undefined behavior.
+ *
+ *  It must be the outermost wrapper, e.g. trusted(prefetch(ifstream(...))).
+ */
+template <typename _Source> struct trusted : public _Source {
+  explicit trusted(_Source &&_source) : _Source(std::move(_source)) {}
+
+  bool is_trusted() const noexcept { return true; }
+};
+
+} // namespace datasource
+} // namespace cppsas7bdat
+
+#endif
@@ -0,0 +1,53 @@
+/**
+ *  \file cppsas7bdat/source/uring.hpp
+ *
+ *  \brief io_uring datasource
+ *
+ *  \author Olivia Quinet
+ */
+
+#ifndef _CPP_SAS7BDAT_SOURCE_URING_HPP_
+#define _CPP_SAS7BDAT_SOURCE_URING_HPP_
+
+#include <cppsas7bdat/properties.hpp>
+#include <memory>
+
+namespace cppsas7bdat {
+namespace datasource {
+
+/**
+ *  Keep up to `depth` page reads in flight with io_uring (Linux).
+ *
+ *  The header is read synchronously.  Once the page length is known (see
+ *  set_header), the pages are read asynchronously in a ring of page
+ *  buffers.  If io_uring is not available, the pages are read with
+ *  pread.
+ */
+struct uring {
+  explicit uring(const char *_pcszfilename, const size_t _depth = 8);
+  uring(uring &&) noexcept;
+  uring &operator=(uring &&) noexcept;
+  ~uring();
+
+  bool eof();
+  bool read_bytes(void *_p, const size_t _length);
+  const void *view_bytes(const size_t _length);
+  void set_header(const Properties::Header &_header);
+
+  size_t size() const noexcept;
+  size_t tell() const noexcept;
+  bool seek(const size_t _position);
+  bool read_bytes_at(void *_p, const size_t _length, const size_t _position);
+
+  /// Return true if the pages are read with io_uring, false with pread.
+  bool is_async() const noexcept;
+
+private:
+  struct impl;
+  std::unique_ptr<impl> m;
+};
+
+} // namespace datasource
+} // namespace cppsas7bdat
+
+#endif
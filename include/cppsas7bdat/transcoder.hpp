@@ -0,0 +1,55 @@
+/**
+ *  \file cppsas7bdat/transcoder.hpp
+ *
+ *  \brief Transcoding of the strings to UTF-8
+ *
+ *  \author Olivia Quinet
+ */
+
+#ifndef _CPP_SAS7BDAT_TRANSCODER_HPP_
+#define _CPP_SAS7BDAT_TRANSCODER_HPP_
+
+#include <cppsas7bdat/types.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace cppsas7bdat {
+
+/**
+ *  Conversion of the strings of a dataset to UTF-8, from its encoding
+ *  (Properties::encoding).
+ *
+ *  The single-byte encodings (WINDOWS-125x, ISO-8859-x, CP4xx-9xx,
+ *  MACxxx) are converted with a table, the runs of ASCII characters being
+ *  copied as is.  The bytes without a character in the encoding become
+ *  U+FFFD.  UTF-8, US-ASCII and the multi-byte encodings (Big5, EUC,
+ *  Shift-JIS, ...) are not supported: the strings are copied unchanged.
+ */
+class Transcoder {
+public:
+  explicit Transcoder(std::string_view _encoding) noexcept;
+
+  /// The strings are converted, i.e. not copied unchanged.
+  bool is_supported() const noexcept { return table != nullptr; }
+  static bool is_supported(std::string_view _encoding) noexcept;
+
+  /// Append _src converted to UTF-8 to _dst.
+  void append(SV _src, std::string &_dst) const;
+  std::string to_utf8(SV _src) const {
+    std::string dst;
+    append(_src, dst);
+    return dst;
+  }
+  /// Convert the _n strings of _src into _buffer (cleared first), _out[i]
+  /// pointing to the string i in _buffer.
+  void to_utf8(const SV *_src, const size_t _n, std::string &_buffer,
+               SV *_out) const;
+
+private:
+  const uint16_t *table{nullptr}; /**< Characters of the bytes 0x80-0xFF */
+};
+
+} // namespace cppsas7bdat
+
+#endif
@@ -11,6 +11,7 @@
 
 #include <cstdint>
 #include <iosfwd>
+#include <limits>
 #include <string>
 #include <string_view>
 
@@ -26,6 +27,11 @@ using INTEGER = int32_t;
 using DATETIME = boost::posix_time::ptime;
 using DATE = boost::gregorian::date;
 using TIME = boost::posix_time::time_duration;
+/// Microseconds (datetime, time of day) or days (date) since 1970-01-01,
+/// see Column::get_epoch.
+using EPOCH = int64_t;
+/// Missing EPOCH value, same as numpy's NaT.
+constexpr EPOCH EPOCH_NA{std::numeric_limits<EPOCH>::min()};
 
 enum class Endian { unknown, little, big };
 enum class Format { bit32, bit64 };
@@ -22,11 +22,15 @@ class MBUFFER {
 private:
   size_t m_size{0};
   MEMORY::PALIGNEDMEM m_buffer{};
+  // Read-only view provided by the data source, e.g. a memory mapping.
+  // When set, it replaces the owned buffer for all the read accesses.
+  const uint8_t *m_view{nullptr};
+  size_t m_view_size{0};
 
 public:
   MBUFFER() {}
   explicit MBUFFER(const size_t _size)
-      : m_size(_size), m_buffer(INTERNAL::MEMORY::aligned_alloc(size())) {}
+      : m_size(_size), m_buffer(INTERNAL::MEMORY::aligned_alloc(_size)) {}
 
   MBUFFER(const MBUFFER &) = delete;
   MBUFFER(MBUFFER &&) = default;
@@ -51,13 +55,47 @@ public:
   template <typename _DataSource>
   bool read_stream(_DataSource &_is, const size_t _read_length,
                    const size_t _offset_in_buffer = 0) {
+    // A full read can directly use a view on the data source...
+    if (_offset_in_buffer == 0) {
+      if (const auto p = _is->view_bytes(_read_length)) {
+        m_view = reinterpret_cast<const uint8_t *>(p);
+        m_view_size = _read_length;
+        return true;
+      }
+    }
+    // ... otherwise, the data must be copied into the buffer.
+    detach();
     // Make sure the buffer is big enough to hold the data
     resize(_offset_in_buffer + _read_length);
     // Read the stream
     return _is->read_bytes(m_buffer.get() + _offset_in_buffer, _read_length);
   }
 
-  size_t size() const noexcept { return m_size; }
+  /// Read _read_length bytes at _position in the data source.
+  template <typename _DataSource>
+  bool read_stream_at(_DataSource &_is, const size_t _read_length,
+                      const size_t _position) {
+    m_view = nullptr;
+    m_view_size = 0;
+    resize(_read_length);
+    return _is->read_bytes_at(m_buffer.get(), _read_length, _position);
+  }
+
+  /// Copy the viewed data, if any, into the owned buffer.
+  void detach() {
+    if (!m_view)
+      return;
+    const auto view = m_view;
+    const auto view_size = m_view_size;
+    m_view = nullptr;
+    m_view_size = 0;
+    resize(view_size);
+    std::memcpy(m_buffer.get(), view, view_size);
+  }
+
+  bool is_view() const noexcept { return m_view != nullptr; }
+
+  size_t size() const noexcept { return m_view ? m_view_size : m_size; }
 
   bool check(const size_t _offset, const size_t _length) const noexcept {
     return _offset + _length <= size();
@@ -74,12 +112,13 @@ public:
 #ifdef DEBUG
     assert_check(_offset, _length);
 #endif
-    return m_buffer.get() + _offset;
+    return (m_view ? m_view : m_buffer.get()) + _offset;
   }
 
+  // Write accesses are on the owned buffer: a view is copied first.
   template <ASSERT _assert = ASSERT::NO>
-  uint8_t *data(const size_t _offset,
-                [[maybe_unused]] const size_t _length) noexcept {
+  uint8_t *data(const size_t _offset, [[maybe_unused]] const size_t _length) {
+    detach();
     if constexpr (_assert == ASSERT::YES) {
       assert_check(_offset, _length);
     } else {
@@ -94,25 +133,24 @@ public:
     return *data(_offset, 1);
   }
 
-  void set(const size_t _offset, const uint8_t _v) noexcept {
+  void set(const size_t _offset, const uint8_t _v) {
     *data(_offset, 1) = _v;
   };
-  void set(const size_t _offset, const uint8_t _v,
-           const size_t _length) noexcept {
+  void set(const size_t _offset, const uint8_t _v, const size_t _length) {
     std::memset(data(_offset, _length), _v, _length);
   };
   void copy(const size_t _offset_dest, const size_t _offset_src,
-            const size_t _length) noexcept {
+            const size_t _length) {
     std::memcpy(data(_offset_dest, _length), data(_offset_src, _length),
                 _length);
   }
-  void copy(const size_t _offset, const BYTES &_src) noexcept {
+  void copy(const size_t _offset, const BYTES &_src) {
     const size_t length = _src.size();
     std::memcpy(data(_offset, length), _src.data(), length);
   }
 
   BYTES as_bytes() const noexcept {
-    return INTERNAL::get_bytes(m_buffer.get(), size());
+    return INTERNAL::get_bytes(data(0, size()), size());
   }
 };
 
@@ -0,0 +1,238 @@
+/**
+ *  \file src/byteswap.hpp
+ *
+ *  \brief Byte swap and widening of runs of values
+ *
+ *  \author Olivia Quinet
+ */
+
+#ifndef _CPP_SAS7BDAT_SRC_BYTESWAP_HPP_
+#define _CPP_SAS7BDAT_SRC_BYTESWAP_HPP_
+
+#include <algorithm>
+#include <boost/endian/conversion.hpp>
+#include <cmath>
+#include <cppsas7bdat/types.hpp>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "types.hpp"
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace cppsas7bdat {
+namespace INTERNAL {
+
+namespace BYTESWAP {
+
+template <size_t _size> struct UINT {};
+template <> struct UINT<2> { using type = uint16_t; };
+template <> struct UINT<4> { using type = uint32_t; };
+template <> struct UINT<8> { using type = uint64_t; };
+
+template <size_t _size>
+inline void scalar(const uint8_t *_src, const size_t _stride, const size_t _n,
+                   uint8_t *_dst) noexcept {
+  using U = typename UINT<_size>::type;
+  for (size_t i = 0; i < _n; ++i, _src += _stride, _dst += _size) {
+    U x;
+    std::memcpy(&x, _src, _size);
+    x = boost::endian::endian_reverse(x);
+    std::memcpy(_dst, &x, _size);
+  }
+}
+
+#if defined(__SSSE3__)
+/// Shuffle reversing the bytes of each _size-byte lane.
+template <size_t _size> inline __m128i mask() noexcept {
+  if constexpr (_size == 8)
+    return _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+  else if constexpr (_size == 4)
+    return _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+  else
+    return _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+}
+#endif
+
+#if defined(__SSE2__)
+/// Reverse the bytes of each _size-byte lane of _x.
+template <size_t _size> inline __m128i swap(const __m128i _x) noexcept {
+#if defined(__SSSE3__)
+  return _mm_shuffle_epi8(_x, mask<_size>());
+#else
+  // Swap the bytes of the 16-bit words then reverse the words.
+  __m128i x = _mm_or_si128(_mm_slli_epi16(_x, 8), _mm_srli_epi16(_x, 8));
+  if constexpr (_size == 4) {
+    x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+    x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+  } else if constexpr (_size == 8) {
+    x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+    x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+  }
+  return x;
+#endif
+}
+
+inline __m128i load(const uint8_t *_p) noexcept {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(_p));
+}
+inline void store(uint8_t *_p, const __m128i _x) noexcept {
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(_p), _x);
+}
+inline int32_t load32(const uint8_t *_p) noexcept {
+  int32_t x;
+  std::memcpy(&x, _p, sizeof(x));
+  return x;
+}
+inline int16_t load16(const uint8_t *_p) noexcept {
+  int16_t x;
+  std::memcpy(&x, _p, sizeof(x));
+  return x;
+}
+#endif
+
+#if defined(__AVX2__)
+template <size_t _size> inline __m256i swap(const __m256i _x) noexcept {
+  return _mm256_shuffle_epi8(_x, _mm256_broadcastsi128_si256(mask<_size>()));
+}
+#endif
+
+} // namespace BYTESWAP
+
+/**
+ *  Reverse the bytes of _n values of _size bytes read at _src, _src +
+ *  _stride, ... and store them contiguously in _dst.
+ *
+ *  With SSE2 (SSSE3, AVX2), 16 (32) bytes of values are swapped at once;
+ *  the values are gathered first when they are not contiguous.
+ */
+template <size_t _size>
+inline void byteswap(const uint8_t *_src, const size_t _stride,
+                     const size_t _n, uint8_t *_dst) noexcept {
+  static_assert(_size == 2 || _size == 4 || _size == 8);
+  size_t i = 0;
+#if defined(__SSE2__)
+  using namespace BYTESWAP;
+  constexpr size_t lanes = 16 / _size;
+  if (_stride == _size) {
+#if defined(__AVX2__)
+    for (; i + 2 * lanes <= _n; i += 2 * lanes) {
+      const auto x = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(_src + i * _size));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(_dst + i * _size),
+                          swap<_size>(x));
+    }
+#endif
+    for (; i + lanes <= _n; i += lanes)
+      store(_dst + i * _size, swap<_size>(load(_src + i * _size)));
+  } else {
+    const uint8_t *p = _src;
+    for (; i + lanes <= _n; i += lanes, p += lanes * _stride) {
+      __m128i x;
+      if constexpr (_size == 8)
+        x = _mm_unpacklo_epi64(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)),
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p + _stride)));
+      else if constexpr (_size == 4)
+        x = _mm_setr_epi32(load32(p), load32(p + _stride),
+                           load32(p + 2 * _stride), load32(p + 3 * _stride));
+      else
+        x = _mm_setr_epi16(load16(p), load16(p + _stride),
+                           load16(p + 2 * _stride), load16(p + 3 * _stride),
+                           load16(p + 4 * _stride), load16(p + 5 * _stride),
+                           load16(p + 6 * _stride), load16(p + 7 * _stride));
+      store(_dst + i * _size, swap<_size>(x));
+    }
+  }
+#endif
+  if (i < _n)
+    BYTESWAP::scalar<_size>(_src + i * _stride, _stride, _n - i,
+                            _dst + i * _size);
+}
+
+/**
+ *  Read _n values of type _Tp stored with the endianness _endian at _src,
+ *  _src + _stride, ... and convert them into _out.
+ */
+template <Endian _endian, typename _Tp, typename _Out>
+inline void get_vals(const uint8_t *_src, const size_t _stride,
+                     const size_t _n, _Out *_out) noexcept {
+  constexpr bool native =
+      (_endian == Endian::big) ==
+      (boost::endian::order::native == boost::endian::order::big);
+  if constexpr (native) {
+    for (size_t i = 0; i < _n; ++i, _src += _stride) {
+      _Tp x;
+      std::memcpy(&x, _src, sizeof(x));
+      _out[i] = static_cast<_Out>(x);
+    }
+  } else if constexpr (std::is_same_v<_Tp, _Out>) {
+    byteswap<sizeof(_Tp)>(_src, _stride, _n,
+                          reinterpret_cast<uint8_t *>(_out));
+  } else {
+    // Swapped by blocks into a buffer then converted.
+    constexpr size_t block = 64;
+    _Tp buf[block];
+    for (size_t i = 0; i < _n; i += block) {
+      const size_t m = std::min(block, _n - i);
+      byteswap<sizeof(_Tp)>(_src + i * _stride, _stride, m,
+                            reinterpret_cast<uint8_t *>(buf));
+      for (size_t j = 0; j < m; ++j)
+        _out[i + j] = static_cast<_Out>(buf[j]);
+    }
+  }
+}
+
+/**
+ *  Read _n doubles truncated to _nbits bytes (see get_incomplete_double)
+ *  at _src, _src + _stride, ... into _out.
+ *
+ *  Each value is loaded with the 8 bytes ending with it: the preceding
+ *  bytes are then masked out (little endian) or shifted out after the
+ *  byte swap (big endian).  The first values, whose 8 bytes would start
+ *  before _src, are read one by one.
+ */
+template <Endian _endian, int _nbits>
+inline void get_incomplete_doubles(const uint8_t *_src, const size_t _stride,
+                                   const size_t _n, NUMBER *_out) noexcept {
+  static_assert(_nbits >= 1 && _nbits < 8);
+  constexpr size_t missing = 8 - _nbits;
+  constexpr int shift = 8 * static_cast<int>(missing);
+  size_t i = 0;
+  for (; i < _n && i * _stride < missing; ++i)
+    _out[i] = get_incomplete_double<_endian, _nbits>(_src + i * _stride);
+#if defined(__SSE2__)
+  for (; i + 2 <= _n; i += 2) {
+    const uint8_t *p = _src + i * _stride - missing;
+    __m128i x = _mm_unpacklo_epi64(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)),
+        _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p + _stride)));
+    if constexpr (_endian == Endian::big)
+      x = _mm_slli_epi64(BYTESWAP::swap<8>(x), shift);
+    else
+      x = _mm_and_si128(x, _mm_set1_epi64x(static_cast<int64_t>(
+                               ~uint64_t{0} << shift)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(_out + i), x);
+  }
+#endif
+  for (; i < _n; ++i) {
+    uint64_t x;
+    std::memcpy(&x, _src + i * _stride - missing, sizeof(x));
+    x = boost::endian::little_to_native(x);
+    if constexpr (_endian == Endian::big)
+      x = boost::endian::endian_reverse(x) << shift;
+    else
+      x &= ~uint64_t{0} << shift;
+    std::memcpy(_out + i, &x, sizeof(x));
+  }
+}
+
+} // namespace INTERNAL
+} // namespace cppsas7bdat
+
+#endif
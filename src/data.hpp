@@ -10,6 +10,12 @@
 #define _CPP_SAS7BDAT_SRC_DATA_HPP_
 
 #include "page.hpp"
+#include "thread_pool.hpp"
+#include <cppsas7bdat/page_index.hpp>
+#include <cppsas7bdat/row_batch.hpp>
+#include <deque>
+#include <limits>
+#include <mutex>
 #include <optional>
 
 namespace cppsas7bdat {
@@ -24,8 +30,14 @@ struct base {
 
   virtual bool next() const noexcept = 0;
   virtual OFFSET_LENGTH read_line() noexcept = 0;
+  virtual size_t row_count_on_page() const noexcept = 0;
+  /// Distance between two consecutive rows, or 0 if they are not stored
+  /// contiguously.
+  virtual size_t row_stride() const noexcept { return 0; }
 
-  void inc_row_on_page() noexcept { ++current_row_on_page; }
+  void inc_row_on_page(const size_t _nrows = 1) noexcept {
+    current_row_on_page += _nrows;
+  }
 };
 
 struct meta_type : public base {
@@ -39,6 +51,9 @@ struct meta_type : public base {
   bool next() const noexcept final {
     return current_row_on_page == data_subheaders.size();
   }
+  size_t row_count_on_page() const noexcept final {
+    return data_subheaders.size();
+  }
   OFFSET_LENGTH read_line() noexcept final {
     const auto &data_subheader = data_subheaders[current_row_on_page];
     return std::make_pair(data_subheader.offset, data_subheader.length);
@@ -60,6 +75,8 @@ struct data_type : public base {
   bool next() const noexcept final {
     return current_row_on_page == block_count;
   }
+  size_t row_count_on_page() const noexcept final { return block_count; }
+  size_t row_stride() const noexcept final { return row_length; }
   OFFSET_LENGTH read_line() noexcept final {
     return std::make_pair(offset + row_length * current_row_on_page,
                           row_length);
@@ -79,6 +96,8 @@ struct mix_type : public base {
   }
 
   bool next() const noexcept final { return current_row_on_page == row_count; }
+  size_t row_count_on_page() const noexcept final { return row_count; }
+  size_t row_stride() const noexcept final { return row_length; }
   OFFSET_LENGTH read_line() noexcept final {
     return std::make_pair(offset + row_length * current_row_on_page,
                           row_length);
@@ -86,8 +105,12 @@ struct mix_type : public base {
 };
 } // namespace PAGE
 
+/**
+ *  With _assert == ASSERT::NO, for trusted files, the rows are not checked
+ *  against the bounds of the page.
+ */
 template <typename _DataSource, Endian _endian, Format _format,
-          typename _Decompressor>
+          typename _Decompressor, ASSERT _assert = ASSERT::YES>
 struct READ_DATA : public READ_PAGE<_DataSource, _endian, _format> {
   using DataSource = _DataSource;
   constexpr static auto endian = _endian;
@@ -100,11 +123,28 @@ struct READ_DATA : public READ_PAGE<_DataSource, _endian, _format> {
   mutable _Decompressor decompressor;
   const Properties::Metadata *metadata{nullptr};
   size_t current_row{0};
+  size_t row_limit{std::numeric_limits<size_t>::max()}; /**< See partition */
   using PPAGE = std::unique_ptr<PAGE::base>;
   PPAGE page;
-
+  CBUFFER peek_buf; /**< Page header and subheader pointers, see skip */
+  PageIndex index;  /**< See seek */
+  std::vector<uint8_t> batch_arena; /**< See read_batch */
+  // The rows on the last page read with the metadata are the data
+  // subheaders that do not match a metadata subheader signature.
+  size_t metadata_page_count{0};
+  DATASUBHEADERS metadata_data_subheaders;
+
+  using READ_PAGE<_DataSource, _endian, _format>::is;
   using READ_PAGE<_DataSource, _endian, _format>::header;
+  using READ_PAGE<_DataSource, _endian, _format>::page_index;
   using READ_PAGE<_DataSource, _endian, _format>::read_page;
+  using READ_PAGE<_DataSource, _endian, _format>::seek_page;
+  using READ_PAGE<_DataSource, _endian, _format>::peek_page;
+  using READ_PAGE<_DataSource, _endian, _format>::page_offset;
+  using READ_PAGE<_DataSource, _endian, _format>::page_count;
+  using READ_PAGE<_DataSource, _endian, _format>::get_page_subheader_pointer;
+  using PAGE_HEADER =
+      typename READ_PAGE<_DataSource, _endian, _format>::PAGE_HEADER;
   using READ_PAGE<_DataSource, _endian, _format>::process_page_subheaders;
   using READ_PAGE<_DataSource, _endian, _format>::current_page_header;
   using READ_PAGE<_DataSource, _endian, _format>::buf;
@@ -115,13 +155,18 @@ struct READ_DATA : public READ_PAGE<_DataSource, _endian, _format> {
                          _Decompressor &&_decompressor,
                          const Properties::Metadata *_metadata) {
     PPAGE page;
+    const size_t metadata_page_count = _rm.page_index;
+    DATASUBHEADERS metadata_data_subheaders = _rm.data_subheaders;
     // Check if we already have data_subheaders from the metadata page...
     if (_rm.data_subheaders.size()) {
       // Yes => build the corresponding meta page by moving the data_subheaders
       page = std::make_unique<PAGE::meta_type>(std::move(_rm.data_subheaders));
     }
-    return READ_DATA(std::move(_rm), std::forward<_Decompressor>(_decompressor),
-                     _metadata, std::move(page));
+    READ_DATA rd(std::move(_rm), std::forward<_Decompressor>(_decompressor),
+                 _metadata, std::move(page));
+    rd.metadata_page_count = metadata_page_count;
+    rd.metadata_data_subheaders = std::move(metadata_data_subheaders);
+    return rd;
   }
 
   READ_DATA(READ_METADATA<_DataSource, _endian, _format> &&_rm,
@@ -144,14 +189,55 @@ struct READ_DATA : public READ_PAGE<_DataSource, _endian, _format> {
     }
   }
 
+  /// Read the same file from another data source, starting at the row
+  /// _partition.first_row and stopping at _partition.end_row.  The header
+  /// and the metadata are not read again.
+  READ_DATA(const READ_DATA &_rd, _DataSource &&_is,
+            const PageIndex::Partition &_partition)
+      : READ_PAGE<_DataSource, _endian, _format>(std::move(_is), CBUFFER(),
+                                                 _rd.header),
+        decompressor(make_decompressor(_rd.metadata)), metadata(_rd.metadata),
+        row_limit(_partition.end_row), index(_rd.index),
+        metadata_page_count(_rd.metadata_page_count),
+        metadata_data_subheaders(_rd.metadata_data_subheaders) {
+    if (is->is_seekable()) {
+      // The page holding the first row is read directly, see seek.
+      if (!is->seek(header->header_length))
+        EXCEPTION::cannot_read_page();
+      is->set_header(*header);
+    } else {
+      if (!buf.read_stream(is, header->header_length))
+        EXCEPTION::header_too_short();
+      is->set_header(*header);
+      // The pages can only be read forward: same state as after the
+      // metadata, see build.
+      while (page_index < metadata_page_count)
+        if (!read_page())
+          EXCEPTION::cannot_read_page();
+      if (!metadata_data_subheaders.empty())
+        page.reset(
+            new PAGE::meta_type(DATASUBHEADERS(metadata_data_subheaders)));
+      else
+        build_page();
+    }
+    // Move to the first row of the partition.
+    if (!seek(_partition.first_row))
+      EXCEPTION::cannot_read_page();
+  }
+
   void set_pmetadata(const Properties::Metadata *_metadata) {
     metadata = _metadata;
   }
 
+  /// Index of the row after the last one to read.
+  size_t end_row() const noexcept {
+    return std::min(row_limit, metadata->row_count);
+  }
+
   bool next() {
-    if (current_row == metadata->row_count)
+    if (current_row >= end_row())
       return false;
-    if (!page)
+    if (!page && !read_next_page())
       return false;
     // Do we need to read a new page from the file?
     if (page->next()) {
@@ -172,12 +258,149 @@ struct READ_DATA : public READ_PAGE<_DataSource, _endian, _format> {
     while (_nrows) {
       if (!next())
         return false;
-      _read_line();
-      --_nrows;
+      // Skip the rows of the current page at once...
+      const size_t nrows = std::min(
+          {_nrows, page->row_count_on_page() - page->current_row_on_page,
+           end_row() - current_row});
+      page->inc_row_on_page(nrows);
+      current_row += nrows;
+      _nrows -= nrows;
+      // ... and the following pages without decoding them.
+      if (_nrows && page->next())
+        skip_pages(_nrows);
     }
     return true;
   }
 
+  /// Skip the pages whose rows are all skipped.  With a seekable data
+  /// source, only the page header and the subheader pointers are read.
+  void skip_pages(size_t &_nrows) {
+    const bool seekable = is->is_seekable();
+    size_t ipage = page_index;
+    while (current_row < end_row()) {
+      PAGE_HEADER page_header;
+      if (seekable) {
+        if (!peek_page(ipage, peek_buf, page_header))
+          break;
+      } else {
+        if (!read_page())
+          return;
+        page_header = current_page_header;
+      }
+      const size_t nrows =
+          count_page_rows(seekable ? peek_buf : buf, page_header);
+      if (nrows >= _nrows) {
+        // The next row to read is on this page.
+        if (!seekable)
+          build_page();
+        break;
+      }
+      current_row += nrows;
+      _nrows -= nrows;
+      ++ipage;
+    }
+    if (seekable) {
+      // A buffering data source refills the views it served on a seek.
+      buf.detach();
+      seek_page(ipage);
+    }
+  }
+
+  /// Number of rows on a page, see build_page.
+  size_t count_page_rows(const CBUFFER &_buf,
+                         const PAGE_HEADER &_page_header) const {
+    if (_page_header.type == PAGE_META_TYPE) {
+      size_t nrows{0};
+      for (uint16_t isubheader = 0;
+           isubheader < _page_header.subheaders_count; ++isubheader) {
+        const auto subheader = get_page_subheader_pointer(
+            _buf, page_bit_offset + 8 + isubheader * this->subheader_size());
+        if (!subheader.length ||
+            subheader.compression == TRUNCATED_SUBHEADER_ID)
+          continue;
+        if (DataSubHeader::check(metadata, subheader))
+          ++nrows;
+      }
+      return nrows;
+    } else if (_page_header.type == PAGE_DATA_TYPE) {
+      return _page_header.block_count;
+    } else if (is_page_mix(_page_header.type)) {
+      return std::min(metadata->row_count, metadata->mix_page_row_count);
+    }
+    return 0;
+  }
+
+  /// Build the index of all the pages from their headers and subheader
+  /// pointers.  The index is empty if the data source is not seekable.
+  PageIndex build_index() {
+    PageIndex idx;
+    const size_t npages = page_count();
+    idx.pages.reserve(npages);
+    size_t first_row{0};
+    for (size_t ipage = 0; ipage < npages; ++ipage) {
+      PAGE_HEADER page_header;
+      if (!peek_page(ipage, peek_buf, page_header))
+        break;
+      const size_t nrows =
+          std::min(is_metadata_data_page(ipage)
+                       ? metadata_data_subheaders.size()
+                   : ipage + 1 < metadata_page_count
+                       ? 0
+                       : count_page_rows(peek_buf, page_header),
+                   metadata->row_count - first_row);
+      idx.pages.push_back({page_offset(ipage), page_header.type, first_row,
+                           nrows});
+      first_row += nrows;
+    }
+    return idx;
+  }
+
+  /// Move to the row _row.  With a seekable data source, the page holding
+  /// the row is found with the index (built on first use) and read
+  /// directly.  Otherwise, the rows can only be skipped forward.
+  bool seek(const size_t _row) {
+    if (_row > metadata->row_count)
+      return false;
+    if (!is->is_seekable()) {
+      if (_row < current_row)
+        return false;
+      return _row == current_row || skip(_row - current_row);
+    }
+    if (_row >= end_row()) {
+      current_row = _row;
+      return true;
+    }
+    if (index.empty())
+      index = build_index();
+    const size_t ipage = index.find(_row);
+    if (ipage == index.pages.size())
+      return false;
+    const auto &entry = index.pages[ipage];
+    if (entry.offset != page_offset(ipage) || !read_page(ipage))
+      return false;
+    if (is_metadata_data_page(ipage))
+      page.reset(new PAGE::meta_type(DATASUBHEADERS(metadata_data_subheaders)));
+    else if (!build_page())
+      return false;
+    current_row = entry.first_row;
+    return skip(_row - current_row);
+  }
+
+  /// Move to the row _row: skip the rows if it is further on the current
+  /// page, otherwise seek its page, i.e. the pages in between are not read.
+  bool move_to(const size_t _row) {
+    if (page && _row >= current_row &&
+        _row - current_row <
+            page->row_count_on_page() - page->current_row_on_page)
+      return skip(_row - current_row);
+    return seek(_row);
+  }
+
+  bool is_metadata_data_page(const size_t _ipage) const noexcept {
+    return _ipage + 1 == metadata_page_count &&
+           !metadata_data_subheaders.empty();
+  }
+
   std::optional<BYTES> read_line() {
     if (!next())
       return {};
@@ -185,11 +408,193 @@ struct READ_DATA : public READ_PAGE<_DataSource, _endian, _format> {
     return extract_row_values(offset, length);
   }
 
+  /// Read the remaining rows of the current page at once.
+  template <typename _Fct> bool read_batch(_Fct _push_rows) {
+    if (!next())
+      return false;
+    RowBatch rows;
+    rows.first_row = current_row;
+    rows.count = std::min(page->row_count_on_page() - page->current_row_on_page,
+                          end_row() - current_row);
+    if (const size_t stride = page->row_stride()) {
+      // Uncompressed rows stored contiguously on the page.
+      const auto offset = page->read_line().first;
+      if constexpr (_assert == ASSERT::YES)
+        FMT_ASSERT(offset + rows.count * stride <= header->page_length,
+                   "Accessing data outside the page");
+      rows.base = buf.get_bytes(offset, rows.count * stride).data();
+      rows.stride = stride;
+      page->inc_row_on_page(rows.count);
+      current_row += rows.count;
+    } else {
+      // The rows are decompressed (or copied) next to each other in the
+      // arena, which is reused for the next pages.
+      rows.base = decode_rows(buf, *page, rows.count, decompressor,
+                              batch_arena, metadata->row_length);
+      rows.stride = metadata->row_length;
+      current_row += rows.count;
+    }
+    _push_rows(rows);
+    return true;
+  }
+
+  /// Rows of a page decoded by a worker thread, see read_all_parallel.
+  struct PAGE_ROWS {
+    CBUFFER page;                 /**< Copy of the page */
+    std::vector<uint8_t> arena;   /**< See decode_rows */
+    const uint8_t *base{nullptr}; /**< Into page or arena */
+    size_t count{0};
+    size_t stride{0};
+  };
+
+  static _Decompressor make_decompressor(const Properties::Metadata *_metadata) {
+    if constexpr (std::is_constructible_v<_Decompressor,
+                                          const Properties::Metadata *>)
+      return _Decompressor(_metadata);
+    else
+      return _Decompressor();
+  }
+
+  /// Decompressors of the worker threads, see read_all_parallel: a worker
+  /// takes one for a page and gives it back, i.e. at most one is built per
+  /// worker.
+  struct DECOMPRESSORS {
+    const Properties::Metadata *metadata{nullptr};
+    std::mutex mutex;
+    std::vector<_Decompressor> available;
+
+    _Decompressor acquire() {
+      {
+        std::lock_guard lock(mutex);
+        if (!available.empty()) {
+          auto decompressor = std::move(available.back());
+          available.pop_back();
+          return decompressor;
+        }
+      }
+      return make_decompressor(metadata);
+    }
+
+    void release(_Decompressor &&_decompressor) {
+      std::lock_guard lock(mutex);
+      available.push_back(std::move(_decompressor));
+    }
+  };
+
+  /// Bytes written by the decompressor after the end of a row.
+  constexpr static size_t arena_padding() noexcept {
+    if constexpr (requires { _Decompressor::WIDE; })
+      return _Decompressor::WIDE;
+    else
+      return 0;
+  }
+
+  /// Extract (and decompress) the next _nrows rows of the page _ppage held
+  /// in _page.  The rows are stored _row_length apart in _arena.
+  static const uint8_t *decode_rows(const CBUFFER &_page, PAGE::base &_ppage,
+                                    const size_t _nrows,
+                                    _Decompressor &_decompress,
+                                    std::vector<uint8_t> &_arena,
+                                    const size_t _row_length) {
+    // Never empty, i.e. valid row pointers even without any column.
+    const size_t size = std::max<size_t>(
+        _nrows * _row_length + arena_padding(), 1);
+    if (_arena.size() < size)
+      _arena.resize(size);
+    auto p = _arena.data();
+    for (size_t irow = 0; irow < _nrows; ++irow, p += _row_length) {
+      const auto [offset, length] = _ppage.read_line();
+      _ppage.inc_row_on_page();
+      if constexpr (_assert == ASSERT::YES)
+        _page.assert_check(offset, length);
+      const auto values = _page.get_bytes(offset, length);
+      if (length >= _row_length) {
+        std::memcpy(p, values.data(), _row_length);
+      } else if constexpr (requires { _decompress(values, p); }) {
+        _decompress(values, p);
+      } else {
+        const auto row = _decompress(values);
+        const size_t n = std::min(row.size(), _row_length);
+        std::memcpy(p, row.data(), n);
+        std::memset(p + n, 0, _row_length - n);
+      }
+    }
+    return _arena.data();
+  }
+
+  /// Extract (and decompress) _nrows rows of the page _page.
+  static PAGE_ROWS decode_page(CBUFFER &&_page, PPAGE &&_ppage,
+                               const size_t _nrows,
+                               const Properties::Metadata *_metadata,
+                               DECOMPRESSORS &_decompressors) {
+    PAGE_ROWS r{std::move(_page), {}, nullptr, _nrows, 0};
+    if (const size_t stride = _ppage->row_stride()) {
+      const auto offset = _ppage->read_line().first;
+      if constexpr (_assert == ASSERT::YES)
+        r.page.assert_check(offset, _nrows * stride);
+      r.base = r.page.get_bytes(offset, _nrows * stride).data();
+      r.stride = stride;
+    } else {
+      auto decompress = _decompressors.acquire();
+      r.base = decode_rows(r.page, *_ppage, _nrows, decompress, r.arena,
+                           _metadata->row_length);
+      r.stride = _metadata->row_length;
+      _decompressors.release(std::move(decompress));
+    }
+    return r;
+  }
+
+  /// Read all the remaining rows: the pages are decoded by _nthreads
+  /// worker threads while _push_rows receives them in order.
+  template <typename _Fct>
+  void read_all_parallel(const size_t _nthreads, _Fct _push_rows) {
+    DECOMPRESSORS decompressors;
+    decompressors.metadata = metadata;
+    THREAD_POOL pool(_nthreads);
+    std::deque<std::future<PAGE_ROWS>> pending;
+    size_t row_index = current_row;
+    auto deliver = [&]() {
+      const auto r = pending.front().get();
+      pending.pop_front();
+      RowBatch rows;
+      rows.first_row = row_index;
+      rows.count = r.count;
+      rows.base = r.base;
+      rows.stride = r.stride;
+      _push_rows(rows);
+      row_index += rows.count;
+    };
+    while (next()) {
+      const size_t nrows =
+          std::min(page->row_count_on_page() - page->current_row_on_page,
+                   end_row() - current_row);
+      // The page buffer is reused (or is a view on the data source): the
+      // worker gets its own copy.
+      CBUFFER copy(buf.size());
+      copy.copy(0, buf.as_bytes());
+      pending.push_back(pool.submit(
+          [copy = std::move(copy), ppage = std::move(page), nrows,
+           md = metadata, &decompressors]() mutable {
+            return decode_page(std::move(copy), std::move(ppage), nrows, md,
+                               decompressors);
+          }));
+      current_row += nrows;
+      // Keep a bounded number of pages in flight.
+      if (pending.size() > 2 * pool.size())
+        deliver();
+      if (current_row < end_row() && !read_next_page())
+        break;
+    }
+    while (!pending.empty())
+      deliver();
+  }
+
   BYTES extract_row_values(const size_t _offset, const size_t _length) const {
     D(spdlog::info("READ_DATA::extract_row_values({}, {})\n", _offset,
                    _length));
-    FMT_ASSERT(_offset + _length <= header->page_length,
-               "Accessing data outside the page");
+    if constexpr (_assert == ASSERT::YES)
+      FMT_ASSERT(_offset + _length <= header->page_length,
+                 "Accessing data outside the page");
     const auto values = buf.get_bytes(_offset, _length);
     if (_length < metadata->row_length) {
       return decompressor(values);
@@ -13,5 +13,9 @@
 namespace cppsas7bdat::datasource {
 
 ifstream::ifstream(const char *_pcszfilename)
-    : is(INTERNAL::open_stream(_pcszfilename)) {}
+    : is(INTERNAL::open_stream(_pcszfilename)) {
+  is.seekg(0, std::ios::end);
+  length = static_cast<size_t>(is.tellg());
+  is.seekg(0);
+}
 } // namespace cppsas7bdat::datasource
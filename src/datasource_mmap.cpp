@@ -0,0 +1,124 @@
+/**
+ *  \file src/datasource_mmap.cpp
+ *
+ *  \brief DataSource mmap
+ *
+ *  \author Olivia Quinet
+ */
+
+#include "debug.hpp"
+#include "exceptions.hpp"
+#include <cppsas7bdat/source/mmap.hpp>
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cppsas7bdat::datasource {
+
+namespace {
+#if defined(_WIN32)
+std::shared_ptr<const uint8_t> map_file(const char *_pcszfilename,
+                                        size_t &_size) {
+  HANDLE hfile = CreateFileA(_pcszfilename, GENERIC_READ, FILE_SHARE_READ,
+                             nullptr, OPEN_EXISTING,
+                             FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (hfile == INVALID_HANDLE_VALUE)
+    EXCEPTION::not_a_valid_file(_pcszfilename);
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(hfile, &size)) {
+    CloseHandle(hfile);
+    EXCEPTION::not_a_valid_file(_pcszfilename);
+  }
+  _size = static_cast<size_t>(size.QuadPart);
+  if (_size == 0) {
+    CloseHandle(hfile);
+    return {};
+  }
+  HANDLE hmapping =
+      CreateFileMappingA(hfile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(hfile);
+  if (!hmapping)
+    EXCEPTION::cannot_map_file(_pcszfilename);
+  const void *p = MapViewOfFile(hmapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(hmapping);
+  if (!p)
+    EXCEPTION::cannot_map_file(_pcszfilename);
+  return std::shared_ptr<const uint8_t>(
+      reinterpret_cast<const uint8_t *>(p),
+      [](const uint8_t *_p) { UnmapViewOfFile(_p); });
+}
+
+void advise_range([[maybe_unused]] const uint8_t *_p,
+                  [[maybe_unused]] const size_t _length,
+                  [[maybe_unused]] const int _advice) noexcept {}
+
+constexpr int MADV_SEQUENTIAL{0};
+constexpr int MADV_WILLNEED{0};
+#else
+std::shared_ptr<const uint8_t> map_file(const char *_pcszfilename,
+                                        size_t &_size) {
+  const int fd = ::open(_pcszfilename, O_RDONLY);
+  if (fd < 0)
+    EXCEPTION::not_a_valid_file(_pcszfilename);
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    EXCEPTION::not_a_valid_file(_pcszfilename);
+  }
+  _size = static_cast<size_t>(st.st_size);
+  if (_size == 0) {
+    ::close(fd);
+    return {};
+  }
+  void *p = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps a reference on the file.
+  ::close(fd);
+  if (p == MAP_FAILED)
+    EXCEPTION::cannot_map_file(_pcszfilename);
+  const size_t size = _size;
+  return std::shared_ptr<const uint8_t>(
+      reinterpret_cast<const uint8_t *>(p), [size](const uint8_t *_p) {
+        ::munmap(const_cast<uint8_t *>(_p), size);
+      });
+}
+
+void advise_range(const uint8_t *_p, const size_t _length,
+                  const int _advice) noexcept {
+  // madvise requires an address aligned on a page boundary.
+  static const auto page_size = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+  const auto address = reinterpret_cast<uintptr_t>(_p);
+  const auto aligned = address & ~(page_size - 1);
+  auto p = reinterpret_cast<void *>(aligned);
+  const size_t length = _length + (address - aligned);
+  ::madvise(p, length, _advice);
+}
+#endif
+} // namespace
+
+mmap::mmap(const char *_pcszfilename) {
+  D(spdlog::info(fmt::format("mmap: [{}]", _pcszfilename)));
+  data = map_file(_pcszfilename, length);
+  if (data)
+    advise_range(data.get(), length, MADV_SEQUENTIAL);
+  advise();
+}
+
+void mmap::advise() noexcept {
+  if (advised >= length)
+    return;
+  const size_t start = std::max(advised, position);
+  advised = std::min(length, position + advise_length);
+  if (advised > start)
+    advise_range(data.get() + start, advised - start, MADV_WILLNEED);
+}
+
+} // namespace cppsas7bdat::datasource
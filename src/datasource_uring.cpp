@@ -0,0 +1,509 @@
+/**
+ *  \file src/datasource_uring.cpp
+ *
+ *  \brief DataSource io_uring
+ *
+ *  \author Olivia Quinet
+ */
+
+#include "debug.hpp"
+#include "exceptions.hpp"
+#include "memory.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cppsas7bdat/source/uring.hpp>
+#include <cstring>
+#include <fmt/core.h>
+#include <optional>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define CPPSAS7BDAT_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace cppsas7bdat::datasource {
+
+namespace {
+#if defined(_WIN32)
+struct FILE_READER {
+  HANDLE h{INVALID_HANDLE_VALUE};
+  size_t size{0};
+
+  explicit FILE_READER(const char *_pcszfilename) {
+    h = CreateFileA(_pcszfilename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                    OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (h == INVALID_HANDLE_VALUE)
+      EXCEPTION::not_a_valid_file(_pcszfilename);
+    LARGE_INTEGER s;
+    if (!GetFileSizeEx(h, &s)) {
+      CloseHandle(h);
+      EXCEPTION::not_a_valid_file(_pcszfilename);
+    }
+    size = static_cast<size_t>(s.QuadPart);
+  }
+  FILE_READER(const FILE_READER &) = delete;
+  FILE_READER &operator=(const FILE_READER &) = delete;
+  ~FILE_READER() { CloseHandle(h); }
+
+  /// Read _length bytes at _offset and return the number of bytes read.
+  size_t read_at(void *_p, const size_t _length, const size_t _offset) {
+    size_t n{0};
+    while (n < _length) {
+      OVERLAPPED ov{};
+      const auto offset = static_cast<uint64_t>(_offset + n);
+      ov.Offset = static_cast<DWORD>(offset);
+      ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+      DWORD r{0};
+      if (!ReadFile(h, static_cast<char *>(_p) + n,
+                    static_cast<DWORD>(_length - n), &r, &ov) ||
+          r == 0)
+        break;
+      n += r;
+    }
+    return n;
+  }
+};
+#else
+struct FILE_READER {
+  int fd{-1};
+  size_t size{0};
+
+  explicit FILE_READER(const char *_pcszfilename) {
+    fd = ::open(_pcszfilename, O_RDONLY);
+    if (fd < 0)
+      EXCEPTION::not_a_valid_file(_pcszfilename);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      EXCEPTION::not_a_valid_file(_pcszfilename);
+    }
+    size = static_cast<size_t>(st.st_size);
+  }
+  FILE_READER(const FILE_READER &) = delete;
+  FILE_READER &operator=(const FILE_READER &) = delete;
+  ~FILE_READER() { ::close(fd); }
+
+  /// Read _length bytes at _offset and return the number of bytes read.
+  size_t read_at(void *_p, const size_t _length, const size_t _offset) {
+    size_t n{0};
+    while (n < _length) {
+      const auto r = ::pread(fd, static_cast<char *>(_p) + n, _length - n,
+                             static_cast<off_t>(_offset + n));
+      if (r < 0 && errno == EINTR)
+        continue;
+      if (r <= 0)
+        break;
+      n += static_cast<size_t>(r);
+    }
+    return n;
+  }
+};
+#endif
+
+#if defined(CPPSAS7BDAT_HAVE_IO_URING)
+/**
+ *  Minimal io_uring wrapper based on the raw system calls, i.e. without
+ *  liburing.
+ */
+class RING {
+public:
+  RING() = default;
+  RING(const RING &) = delete;
+  RING &operator=(const RING &) = delete;
+  ~RING() {
+    if (sqes)
+      ::munmap(sqes, sqes_length);
+    if (cq_ptr && cq_ptr != sq_ptr)
+      ::munmap(cq_ptr, cq_length);
+    if (sq_ptr)
+      ::munmap(sq_ptr, sq_length);
+    if (fd >= 0)
+      ::close(fd);
+  }
+
+  bool init(const unsigned _entries) noexcept {
+    io_uring_params p;
+    std::memset(&p, 0, sizeof(p));
+    fd = static_cast<int>(::syscall(__NR_io_uring_setup, _entries, &p));
+    if (fd < 0)
+      return false;
+    sq_length = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_length = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap)
+      sq_length = cq_length = std::max(sq_length, cq_length);
+    sq_ptr = map(sq_length, IORING_OFF_SQ_RING);
+    if (!sq_ptr)
+      return false;
+    cq_ptr = single_mmap ? sq_ptr : map(cq_length, IORING_OFF_CQ_RING);
+    if (!cq_ptr)
+      return false;
+    sqes_length = p.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe *>(map(sqes_length, IORING_OFF_SQES));
+    if (!sqes)
+      return false;
+
+    auto sq = static_cast<uint8_t *>(sq_ptr);
+    sq_tail = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+    sq_mask = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+    auto cq = static_cast<uint8_t *>(cq_ptr);
+    cq_head = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+    cq_mask = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+    return true;
+  }
+
+  /// Queue a read; the iovec must stay valid until the read is completed.
+  void prepare_read(const int _fd, const iovec *_iov, const uint64_t _offset,
+                    const uint64_t _user_data) noexcept {
+    const unsigned tail = *sq_tail;
+    const unsigned index = tail & sq_mask;
+    auto sqe = &sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = _fd;
+    sqe->addr = reinterpret_cast<uint64_t>(_iov);
+    sqe->len = 1;
+    sqe->off = _offset;
+    sqe->user_data = _user_data;
+    sq_array[index] = index;
+    std::atomic_ref<unsigned>(*sq_tail).store(tail + 1,
+                                              std::memory_order_release);
+    ++pending;
+  }
+
+  bool submit() noexcept {
+    while (pending) {
+      const auto r = enter(pending, 0, 0);
+      if (r < 0) {
+        if (errno == EINTR)
+          continue;
+        return false;
+      }
+      pending -= static_cast<unsigned>(r);
+    }
+    return true;
+  }
+
+  /// Wait for the next completion.
+  bool wait(uint64_t &_user_data, int &_result) noexcept {
+    for (;;) {
+      const unsigned head = *cq_head;
+      const unsigned tail =
+          std::atomic_ref<unsigned>(*cq_tail).load(std::memory_order_acquire);
+      if (head != tail) {
+        const auto cqe = &cqes[head & cq_mask];
+        _user_data = cqe->user_data;
+        _result = cqe->res;
+        std::atomic_ref<unsigned>(*cq_head).store(head + 1,
+                                                  std::memory_order_release);
+        return true;
+      }
+      if (enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+        return false;
+    }
+  }
+
+private:
+  int fd{-1};
+  void *sq_ptr{nullptr};
+  void *cq_ptr{nullptr};
+  io_uring_sqe *sqes{nullptr};
+  size_t sq_length{0};
+  size_t cq_length{0};
+  size_t sqes_length{0};
+  unsigned *sq_tail{nullptr};
+  unsigned *sq_array{nullptr};
+  unsigned sq_mask{0};
+  unsigned *cq_head{nullptr};
+  unsigned *cq_tail{nullptr};
+  unsigned cq_mask{0};
+  io_uring_cqe *cqes{nullptr};
+  unsigned pending{0};
+
+  void *map(const size_t _length, const off_t _offset) noexcept {
+    void *p = ::mmap(nullptr, _length, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, _offset);
+    return p == MAP_FAILED ? nullptr : p;
+  }
+
+  long enter(const unsigned _to_submit, const unsigned _min_complete,
+             const unsigned _flags) noexcept {
+    return ::syscall(__NR_io_uring_enter, fd, _to_submit, _min_complete,
+                     _flags, nullptr, 0);
+  }
+};
+#endif
+} // namespace
+
+struct uring::impl {
+  struct SLOT {
+    INTERNAL::MEMORY::PALIGNEDMEM buffer;
+    size_t length{0}; /**< Number of bytes read in the buffer */
+    bool ready{false};
+#if defined(CPPSAS7BDAT_HAVE_IO_URING)
+    iovec iov{};
+#endif
+  };
+
+  FILE_READER file;
+  size_t depth;
+  size_t position{0}; /**< Position of the sequential reads */
+  size_t page_length{0};
+  size_t first_page_offset{0};
+  size_t page_count{0}; /**< Number of complete pages in the file */
+  size_t current_page{0};
+  size_t offset{0}; /**< Offset in the current page */
+  std::vector<SLOT> slots;
+#if defined(CPPSAS7BDAT_HAVE_IO_URING)
+  std::optional<RING> ring;
+#endif
+
+  impl(const char *_pcszfilename, const size_t _depth)
+      : file(_pcszfilename), depth(std::max<size_t>(_depth, 1)) {}
+
+  ~impl() {
+    // The buffers must outlive the reads in flight.
+    try {
+      for (auto &slot : slots)
+        wait(slot);
+    } catch (...) {
+    }
+  }
+
+  bool is_paging() const noexcept { return !slots.empty(); }
+  bool is_async() const noexcept {
+#if defined(CPPSAS7BDAT_HAVE_IO_URING)
+    return ring.has_value();
+#else
+    return false;
+#endif
+  }
+
+  size_t page_offset(const size_t _page) const noexcept {
+    return first_page_offset + _page * page_length;
+  }
+
+  void set_header(const Properties::Header &_header) {
+    if (is_paging() || _header.page_length == 0 || position >= file.size)
+      return;
+    // The page count in the header is not always set: the number of pages
+    // is deduced from the size of the file.
+    page_length = _header.page_length;
+    first_page_offset = position;
+    page_count = (file.size - position) / page_length;
+    if (page_count == 0)
+      return;
+    slots.resize(std::min(depth, page_count));
+    for (auto &slot : slots)
+      slot.buffer.reset(INTERNAL::MEMORY::aligned_alloc(page_length));
+#if defined(CPPSAS7BDAT_HAVE_IO_URING)
+    ring.emplace();
+    if (!ring->init(static_cast<unsigned>(slots.size())))
+      ring.reset();
+    D(spdlog::info("uring: io_uring {}\n", ring ? "enabled" : "disabled"));
+#endif
+    for (size_t ipage = 0; ipage < slots.size(); ++ipage)
+      submit(ipage);
+    flush();
+  }
+
+  void submit(const size_t _page) {
+    auto &slot = slots[_page % slots.size()];
+    slot.ready = false;
+    slot.length = 0;
+#if defined(CPPSAS7BDAT_HAVE_IO_URING)
+    if (ring) {
+      slot.iov.iov_base = slot.buffer.get();
+      slot.iov.iov_len = page_length;
+      ring->prepare_read(file.fd, &slot.iov, page_offset(_page), _page);
+      return;
+    }
+#endif
+    slot.length = file.read_at(slot.buffer.get(), page_length, page_offset(_page));
+    slot.ready = true;
+  }
+
+  void flush() {
+#if defined(CPPSAS7BDAT_HAVE_IO_URING)
+    if (ring && !ring->submit())
+      EXCEPTION::cannot_read_page();
+#endif
+  }
+
+  void wait(SLOT &_slot) {
+#if defined(CPPSAS7BDAT_HAVE_IO_URING)
+    while (!_slot.ready) {
+      uint64_t ipage{0};
+      int result{0};
+      if (!ring || !ring->wait(ipage, result))
+        EXCEPTION::cannot_read_page();
+      auto &slot = slots[ipage % slots.size()];
+      // In case of error or short read, the rest of the page is read
+      // synchronously.
+      slot.length = result > 0 ? static_cast<size_t>(result) : 0;
+      if (slot.length < page_length)
+        slot.length += file.read_at(slot.buffer.get() + slot.length,
+                                    page_length - slot.length,
+                                    page_offset(ipage) + slot.length);
+      slot.ready = true;
+    }
+#else
+    static_cast<void>(_slot);
+#endif
+  }
+
+  /// Return the page being consumed or nullptr if all the pages have
+  /// been consumed.
+  SLOT *current() {
+    if (current_page < page_count && offset >= page_length) {
+      // The current page has been consumed: reuse its slot.
+      const size_t next_page = current_page + slots.size();
+      if (next_page < page_count) {
+        submit(next_page);
+        flush();
+      }
+      ++current_page;
+      offset = 0;
+      if (current_page == page_count)
+        position = page_offset(page_count);
+    }
+    if (current_page >= page_count)
+      return nullptr;
+    auto &slot = slots[current_page % slots.size()];
+    wait(slot);
+    return &slot;
+  }
+
+  bool eof() {
+    if (is_paging() && current() != nullptr)
+      return false;
+    return position >= file.size;
+  }
+
+  bool read_bytes(void *_p, size_t _length) {
+    auto p = static_cast<uint8_t *>(_p);
+    while (_length && is_paging()) {
+      auto slot = current();
+      if (!slot)
+        break;
+      if (slot->length != page_length)
+        return false;
+      const size_t n = std::min(_length, page_length - offset);
+      std::memcpy(p, slot->buffer.get() + offset, n);
+      offset += n;
+      p += n;
+      _length -= n;
+    }
+    if (!_length)
+      return true;
+    const size_t n = file.read_at(p, _length, position);
+    position += n;
+    if (n != _length)
+      position = std::max(position, file.size);
+    // Back within the pages after a seek outside of them, e.g. in the
+    // header: the pages are read ahead again.
+    else if (is_paging())
+      arm(position);
+    return n == _length;
+  }
+
+  size_t tell() const noexcept {
+    if (is_paging() && current_page < page_count)
+      return page_offset(current_page) + offset;
+    return position;
+  }
+
+  /// Read the pages from the one holding _position if it is within the
+  /// complete pages.  No read must be in flight.
+  bool arm(const size_t _position) {
+    if (_position < first_page_offset || _position >= page_offset(page_count))
+      return false;
+    current_page = (_position - first_page_offset) / page_length;
+    offset = _position - page_offset(current_page);
+    const size_t last_page = std::min(page_count, current_page + slots.size());
+    for (size_t ipage = current_page; ipage < last_page; ++ipage)
+      submit(ipage);
+    flush();
+    return true;
+  }
+
+  bool seek(const size_t _position) {
+    if (is_paging()) {
+      // The reads in flight must be completed before reusing the slots.
+      for (auto &slot : slots)
+        wait(slot);
+      if (arm(_position))
+        return true;
+      current_page = page_count;
+      offset = 0;
+    }
+    position = _position;
+    return true;
+  }
+
+  const void *view_bytes(const size_t _length) {
+    if (!is_paging() || _length != page_length)
+      return nullptr;
+    auto slot = current();
+    if (!slot || offset != 0 || slot->length != page_length)
+      return nullptr;
+    // The slot is reused once the view has been replaced by the next page.
+    offset = page_length;
+    return slot->buffer.get();
+  }
+};
+
+uring::uring(const char *_pcszfilename, const size_t _depth)
+    : m(std::make_unique<impl>(_pcszfilename, _depth)) {
+  D(spdlog::info(fmt::format("uring: [{}]", _pcszfilename)));
+}
+uring::uring(uring &&) noexcept = default;
+uring &uring::operator=(uring &&) noexcept = default;
+uring::~uring() = default;
+
+bool uring::eof() { return m->eof(); }
+
+bool uring::read_bytes(void *_p, const size_t _length) {
+  return m->read_bytes(_p, _length);
+}
+
+const void *uring::view_bytes(const size_t _length) {
+  return m->view_bytes(_length);
+}
+
+void uring::set_header(const Properties::Header &_header) {
+  m->set_header(_header);
+}
+
+bool uring::is_async() const noexcept { return m->is_async(); }
+
+size_t uring::size() const noexcept { return m->file.size; }
+
+size_t uring::tell() const noexcept { return m->tell(); }
+
+bool uring::seek(const size_t _position) { return m->seek(_position); }
+
+bool uring::read_bytes_at(void *_p, const size_t _length,
+                          const size_t _position) {
+  return m->file.read_at(_p, _length, _position) == _length;
+}
+
+} // namespace cppsas7bdat::datasource
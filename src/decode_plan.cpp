@@ -0,0 +1,226 @@
+/**
+ *  \file src/decode_plan.cpp
+ *
+ *  \brief Decode plan
+ *
+ *  \author Olivia Quinet
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cppsas7bdat/decode_plan.hpp>
+#include <tuple>
+#include <type_traits>
+
+#include "types.hpp"
+
+namespace cppsas7bdat {
+
+namespace {
+using Op = Column::Op;
+using Step = DecodePlan::Step;
+
+template <Endian _endian> using ENDIAN = std::integral_constant<Endian, _endian>;
+
+/// Call _fct with the endianness as a compile-time constant.
+template <typename _Fct> void with_endian(const Endian _endian, _Fct _fct) {
+  if (_endian == Endian::big)
+    _fct(ENDIAN<Endian::big>{});
+  else
+    _fct(ENDIAN<Endian::little>{});
+}
+
+template <Endian _endian, int _nbits>
+void decode_numbers(const Step *_begin, const Step *_end, const uint8_t *_p,
+                    NUMBER *_out) noexcept {
+  for (auto s = _begin; s != _end; ++s) {
+    if constexpr (_nbits == 8)
+      _out[s->index] = INTERNAL::get_double<_endian>(_p + s->offset);
+    else
+      _out[s->index] =
+          INTERNAL::get_incomplete_double<_endian, _nbits>(_p + s->offset);
+  }
+}
+
+/// Generic path: the value is extracted by the column itself.
+void decode_column(const Column &_column, Column::PBUF _p, const size_t _index,
+                   DecodePlan::Values &_values) {
+  switch (_column.type) {
+  case Column::Type::string:
+    _values.strings[_index] = _column.get_string(_p);
+    break;
+  case Column::Type::number:
+    _values.numbers[_index] = _column.get_number(_p);
+    break;
+  case Column::Type::integer:
+    _values.integers[_index] = _column.get_integer(_p);
+    break;
+  case Column::Type::datetime:
+    _values.datetimes[_index] = _column.get_datetime(_p);
+    break;
+  case Column::Type::date:
+    _values.dates[_index] = _column.get_date(_p);
+    break;
+  case Column::Type::time:
+    _values.times[_index] = _column.get_time(_p);
+    break;
+  case Column::Type::unknown:
+    break;
+  }
+}
+
+const COLUMNS &get_columns(const Columns &_columns, const Column::Type _type) {
+  switch (_type) {
+  case Column::Type::number:
+    return _columns.numbers;
+  case Column::Type::integer:
+    return _columns.integers;
+  case Column::Type::datetime:
+    return _columns.datetimes;
+  case Column::Type::date:
+    return _columns.dates;
+  case Column::Type::time:
+    return _columns.times;
+  default:
+    return _columns.strings;
+  }
+}
+} // namespace
+
+DecodePlan::DecodePlan(const COLUMNS &_columns) : m_columns(_columns) {
+  for (const auto type : {Column::Type::string, Column::Type::number,
+                          Column::Type::integer, Column::Type::datetime,
+                          Column::Type::date, Column::Type::time}) {
+    const auto &columns = get_columns(m_columns, type);
+    for (size_t i = 0; i < columns.size(); ++i) {
+      const auto layout = columns[i].layout();
+      // A number is decoded from 3 to 8 bytes
+      const bool known =
+          layout.op != Op::none &&
+          (layout.op != Op::number || (layout.length >= 3 && layout.length <= 8));
+      m_steps.push_back({static_cast<uint32_t>(layout.offset),
+                         static_cast<uint32_t>(layout.length),
+                         static_cast<uint32_t>(i), known ? layout.op : Op::none,
+                         type, layout.endian});
+    }
+  }
+  // Grouped by operation (and length for the numbers), then in the order
+  // of the row.
+  auto length = [](const Step &_s) {
+    return _s.op == Op::number ? _s.length : 0;
+  };
+  auto key = [&](const Step &_s) {
+    return std::make_tuple(_s.op, _s.endian, length(_s), _s.offset);
+  };
+  std::stable_sort(
+      m_steps.begin(), m_steps.end(),
+      [&](const Step &_a, const Step &_b) { return key(_a) < key(_b); });
+  for (size_t i = 0; i < m_steps.size(); ++i) {
+    const auto &s = m_steps[i];
+    if (!m_groups.empty()) {
+      const auto &prev = m_steps[i - 1];
+      if (s.op != Op::none && s.op == prev.op && s.endian == prev.endian &&
+          length(s) == length(prev)) {
+        m_groups.back().end = static_cast<uint32_t>(i + 1);
+        continue;
+      }
+    }
+    m_groups.push_back(
+        {static_cast<uint32_t>(i), static_cast<uint32_t>(i + 1)});
+  }
+}
+
+DecodePlan::Values DecodePlan::make_values() const {
+  Values values;
+  values.strings.resize(m_columns.strings.size());
+  values.numbers.resize(m_columns.numbers.size());
+  values.integers.resize(m_columns.integers.size());
+  values.datetimes.resize(m_columns.datetimes.size());
+  values.dates.resize(m_columns.dates.size());
+  values.times.resize(m_columns.times.size());
+  return values;
+}
+
+void DecodePlan::decode(Column::PBUF _p, Values &_values) const {
+  const auto p = static_cast<const uint8_t *>(_p);
+  for (const auto &group : m_groups) {
+    const Step *begin = m_steps.data() + group.begin;
+    const Step *end = m_steps.data() + group.end;
+    switch (begin->op) {
+    case Op::string:
+      for (auto s = begin; s != end; ++s)
+        _values.strings[s->index] =
+            INTERNAL::get_string_trim_0(p + s->offset, s->length);
+      break;
+    case Op::uint8:
+      for (auto s = begin; s != end; ++s)
+        _values.integers[s->index] = p[s->offset];
+      break;
+    case Op::int16:
+      with_endian(begin->endian, [&](auto _endian) {
+        constexpr Endian e = decltype(_endian)::value;
+        for (auto s = begin; s != end; ++s)
+          _values.integers[s->index] =
+              INTERNAL::get_val<e, int16_t>(p + s->offset);
+      });
+      break;
+    case Op::number:
+      with_endian(begin->endian, [&](auto _endian) {
+        constexpr Endian e = decltype(_endian)::value;
+        auto out = _values.numbers.data();
+        switch (begin->length) {
+        case 3:
+          decode_numbers<e, 3>(begin, end, p, out);
+          break;
+        case 4:
+          decode_numbers<e, 4>(begin, end, p, out);
+          break;
+        case 5:
+          decode_numbers<e, 5>(begin, end, p, out);
+          break;
+        case 6:
+          decode_numbers<e, 6>(begin, end, p, out);
+          break;
+        case 7:
+          decode_numbers<e, 7>(begin, end, p, out);
+          break;
+        default:
+          decode_numbers<e, 8>(begin, end, p, out);
+          break;
+        }
+      });
+      break;
+    case Op::datetime:
+      with_endian(begin->endian, [&](auto _endian) {
+        constexpr Endian e = decltype(_endian)::value;
+        for (auto s = begin; s != end; ++s)
+          _values.datetimes[s->index] = INTERNAL::get_datetime_from_epoch(
+              INTERNAL::get_double<e>(p + s->offset));
+      });
+      break;
+    case Op::date:
+      with_endian(begin->endian, [&](auto _endian) {
+        constexpr Endian e = decltype(_endian)::value;
+        for (auto s = begin; s != end; ++s)
+          _values.dates[s->index] = INTERNAL::get_date_from_epoch(
+              INTERNAL::get_double<e>(p + s->offset));
+      });
+      break;
+    case Op::time:
+      with_endian(begin->endian, [&](auto _endian) {
+        constexpr Endian e = decltype(_endian)::value;
+        for (auto s = begin; s != end; ++s)
+          _values.times[s->index] = INTERNAL::get_time_from_epoch(
+              INTERNAL::get_double<e>(p + s->offset));
+      });
+      break;
+    case Op::none:
+      for (auto s = begin; s != end; ++s)
+        decode_column(get_columns(m_columns, s->type)[s->index], _p, s->index,
+                      _values);
+      break;
+    }
+  }
+}
+
+} // namespace cppsas7bdat
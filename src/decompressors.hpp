@@ -9,6 +9,8 @@
 #ifndef _CPP_SAS7BDAT_SRC_DECOMPRESSORS_HPP_
 #define _CPP_SAS7BDAT_SRC_DECOMPRESSORS_HPP_
 
+#include <bit>
+
 namespace cppsas7bdat {
 namespace INTERNAL {
 namespace DECOMPRESSOR {
@@ -42,14 +44,36 @@ struct None {
   }
 };
 
+/**
+ *  Length of the beginning of the rows read by the (filtered) columns: the
+ *  rest of the rows does not need to be decompressed.
+ */
+inline size_t used_row_length(const Properties::Metadata *_metadata) {
+  if (_metadata->columns.empty())
+    return _metadata->row_length;
+  size_t n = 0;
+  for (const auto &column : _metadata->columns) {
+    const auto offset = column.offset();
+    if (!offset)
+      return _metadata->row_length;
+    n = std::max(n, *offset + column.length());
+  }
+  return std::min(n, _metadata->row_length);
+}
+
 template <Endian _endian, Format _format> struct DST_VALUES {
   BUFFER<_endian, _format> buf;
   const size_t n_dst{0};
+  const size_t n_stop{0}; /**< The decompression can stop here */
   size_t i_dst{0};
 
-  explicit DST_VALUES(const Properties::Metadata *_metadata)
-      : DST_VALUES(_metadata->row_length) {}
-  explicit DST_VALUES(const size_t _n) : buf(_n), n_dst(_n) {}
+  explicit DST_VALUES(const Properties::Metadata *_metadata,
+                      const size_t _padding = 0)
+      : buf(_metadata->row_length + _padding), n_dst(_metadata->row_length),
+        n_stop(used_row_length(_metadata)) {}
+  /// _padding bytes are allocated after the _n bytes of the destination.
+  explicit DST_VALUES(const size_t _n, const size_t _padding = 0)
+      : buf(_n + _padding), n_dst(_n), n_stop(_n) {}
 
   DST_VALUES(const DST_VALUES &) = delete;
   DST_VALUES(DST_VALUES &&) noexcept = default;
@@ -80,83 +104,155 @@ template <Endian _endian, Format _format> struct DST_VALUES {
   }
 };
 
-/// SASYZCR2
-template <Endian _endian, Format _format>
+/**
+ *  SASYZCR2
+ *
+ *  With _assert == ASSERT::NO, for trusted files, the destination bounds
+ *  and the pattern offsets are not checked.
+ */
+template <Endian _endian, Format _format, ASSERT _assert = ASSERT::YES>
 struct RDC : public DST_VALUES<_endian, _format> {
   using DST_VALUES<_endian, _format>::buf;
   using DST_VALUES<_endian, _format>::n_dst;
+  using DST_VALUES<_endian, _format>::n_stop;
   using DST_VALUES<_endian, _format>::reset;
-  using DST_VALUES<_endian, _format>::fill;
-  using DST_VALUES<_endian, _format>::check;
   using DST_VALUES<_endian, _format>::assert_check;
-  using DST_VALUES<_endian, _format>::store_value;
   using DST_VALUES<_endian, _format>::i_dst;
 
+  constexpr static size_t WIDE{32}; /**< Longest literal run/short rle */
+
   explicit RDC(const Properties::Metadata *_metadata)
-      : DST_VALUES<_endian, _format>(_metadata) {}
+      : DST_VALUES<_endian, _format>(_metadata, WIDE) {}
 
-  void store_pattern(const size_t _offset, const size_t _n) {
-    assert_check(_n);
-    buf.copy(i_dst, i_dst - _offset, _n);
-    i_dst += _n;
+  /**
+   *  A whole 16-bit control word is processed per iteration and the
+   *  consecutive literal bytes are copied at once.  The bounds are checked
+   *  once per command; as for RLE, the destination is padded with WIDE
+   *  bytes for the fixed size stores of the short runs.  The overlapping
+   *  patterns are copied forward by non-overlapping chunks of growing size.
+   *  The decompression stops once the n_stop bytes read by the columns are
+   *  available; the end of the row is only zero filled.
+   */
+  BYTES operator()(const BYTES &_values) {
+    return (*this)(_values, buf.data(0, n_dst + WIDE));
   }
 
-  BYTES operator()(const BYTES &_values) {
-    constexpr uint8_t ONE{1}, FOUR{4}, EIGHT{8};
-    constexpr uint8_t THREE{3}, SIXTEEN{16}, NINETEEN{19};
+  /// Decompress _values into _dst, followed by at least WIDE bytes.
+  BYTES operator()(const BYTES &_values, uint8_t *_dst) {
+    constexpr uint8_t FOUR{4}, EIGHT{8};
+    constexpr size_t THREE{3}, SIXTEEN{16}, NINETEEN{19};
 
     reset();
+    const uint8_t *s = _values.data();
+    const uint8_t *const s_end = s + _values.size();
+    uint8_t *const d_begin = _dst;
+    uint8_t *d = d_begin;
+    uint8_t *const d_end = d_begin + n_dst;
+    uint8_t *const d_stop = d_begin + n_stop;
 
-    using T = int32_t;
-    SRC_VALUES src(_values);
-    T ctrl_mask{0};
-    T ctrl_bits{0};
-
-    while (src.check(3) && check()) {
-      D(spdlog::info("RDC({}/{},{}/{})\n", src.i_src, src.n_src, i_dst, n_dst));
-      // get new load of control bits if needed
-      ctrl_mask >>= ONE;
-      if (ctrl_mask == 0) {
-        // The 2 next lines must be performed in that order
-        ctrl_bits = (static_cast<T>(src.pop())) << EIGHT;
-        ctrl_bits += (static_cast<T>(src.pop()));
-        ctrl_mask = 0x8000;
+    auto remaining = [&]() { return static_cast<size_t>(s_end - s); };
+    auto room = [&]() { return static_cast<size_t>(d_end - d); };
+    auto check_room = [&](const size_t _n) {
+      if constexpr (_assert == ASSERT::YES) {
+        if (_n > room()) {
+          i_dst = static_cast<size_t>(d - d_begin);
+          assert_check(_n);
+        }
       }
-      // just copy this char if control bit is zero
-      if ((ctrl_bits & ctrl_mask) == 0) {
-        store_value(src.pop(), 1);
-      } else {
+    };
+    auto insert_value = [&](const uint8_t _v, const size_t _n) {
+      check_room(_n);
+      if (_n <= WIDE)
+        std::memset(d, _v, WIDE);
+      else
+        std::memset(d, _v, _n);
+      d += _n;
+    };
+    auto copy_pattern = [&](const size_t _offset, size_t _n) {
+      check_room(_n);
+      if constexpr (_assert == ASSERT::YES) {
+        if (_offset > static_cast<size_t>(d - d_begin)) {
+          spdlog::critical("Invalid pattern offset: {} at {}\n", _offset,
+                           d - d_begin);
+          EXCEPTION::cannot_decompress();
+        }
+      }
+      const uint8_t *p = d - _offset;
+      if (_n <= 16 && _offset >= 16) {
+        std::memcpy(d, p, 16);
+        d += _n;
+        return;
+      }
+      if (_n <= 16) {
+        // Short (overlapping) pattern: byte by byte
+        for (const auto end = d + _n; d != end;)
+          *d++ = *p++;
+        return;
+      }
+      // [p, d) is repeated: each chunk is at most d - p long.
+      while (_n) {
+        const size_t n = std::min(_n, static_cast<size_t>(d - p));
+        std::memcpy(d, p, n);
+        d += n;
+        _n -= n;
+      }
+    };
+
+    // Each step needs 3 source bytes, the control word included.
+    while (remaining() >= THREE && d < d_stop) {
+      // The control bits of the next steps are the highest bits.
+      uint32_t ctrl_bits = static_cast<uint32_t>(s[0] << EIGHT | s[1]) << 16;
+      s += 2;
+      for (size_t step = 0; step < 16;) {
+        if (step && !(remaining() >= THREE && d < d_stop))
+          break;
+        D(spdlog::info("RDC({}/{},{}/{})\n", s - _values.data(),
+                       _values.size(), d - d_begin, n_dst));
+        if ((ctrl_bits & 0x80000000) == 0) {
+          // Literal bytes: the checks of the next steps hold for all of them
+          const size_t n = std::min<size_t>(
+              static_cast<size_t>(std::countl_zero(ctrl_bits)), 16 - step);
+          if (remaining() >= n + 2 && room() >= n) {
+            if (remaining() >= 16)
+              std::memcpy(d, s, 16);
+            else
+              std::memcpy(d, s, n);
+            d += n;
+            s += n;
+            ctrl_bits <<= n;
+            step += n;
+          } else {
+            *d++ = *s++;
+            ctrl_bits <<= 1;
+            ++step;
+          }
+          continue;
+        }
         // undo the compression code
-        const auto val = src.pop();
+        const auto val = *s++;
         const uint8_t cmd = (val >> FOUR) & 0x0F;
         size_t cnt = val & 0x0F;
         if (cmd == 0) { // short rle
           cnt += THREE;
-          store_value(src.pop(), cnt);
+          insert_value(*s++, cnt);
         } else if (cmd == 1) { // long rle
-          cnt += static_cast<size_t>((static_cast<T>(src.pop()) << FOUR) +
-                                     NINETEEN);
-          store_value(src.pop(), cnt);
+          cnt += (static_cast<size_t>(*s++) << FOUR) + NINETEEN;
+          insert_value(*s++, cnt);
         } else if (cmd == 2) { // long pattern
-          const size_t ofs =
-              cnt + THREE +
-              static_cast<size_t>(static_cast<T>(src.pop()) << FOUR);
-          cnt = static_cast<size_t>(src.pop() + SIXTEEN);
-          store_pattern(ofs, cnt);
-        } else if (cmd >= 3 && cmd <= 15) { // short pattern
-          const size_t ofs =
-              cnt + THREE +
-              static_cast<size_t>(static_cast<T>(src.pop()) << FOUR);
-          store_pattern(ofs, cmd);
-        } else {
-          spdlog::critical("unknown marker {:#X} at offset {}\n", val,
-                           (src.i_src - 1));
-          EXCEPTION::cannot_decompress();
+          const size_t ofs = cnt + THREE + (static_cast<size_t>(*s++) << FOUR);
+          cnt = *s++ + SIXTEEN;
+          copy_pattern(ofs, cnt);
+        } else { // short pattern
+          const size_t ofs = cnt + THREE + (static_cast<size_t>(*s++) << FOUR);
+          copy_pattern(ofs, cmd);
         }
+        ctrl_bits <<= 1;
+        ++step;
       }
     }
-    fill();
-    return buf.as_bytes();
+    std::memset(d, C_NULL, static_cast<size_t>(d_end - d));
+    i_dst = n_dst;
+    return INTERNAL::get_bytes(d_begin, n_dst);
   }
 };
 
@@ -177,93 +273,145 @@ constexpr uint8_t SAS_RLE_COMMAND_INSERT_ZERO2 = 0X0F;
 /// SASYZCRL
 /**
  *  From https://github.com/WizardMac/ReadStat
+ *
+ *  With _assert == ASSERT::NO, for trusted files, the destination bounds
+ *  are not checked.
  */
-template <Endian _endian, Format _format>
+template <Endian _endian, Format _format, ASSERT _assert = ASSERT::YES>
 struct RLE : public DST_VALUES<_endian, _format> {
   using DST_VALUES<_endian, _format>::buf;
   using DST_VALUES<_endian, _format>::n_dst;
+  using DST_VALUES<_endian, _format>::n_stop;
   using DST_VALUES<_endian, _format>::reset;
-  using DST_VALUES<_endian, _format>::fill;
-  using DST_VALUES<_endian, _format>::check;
   using DST_VALUES<_endian, _format>::assert_check;
-  using DST_VALUES<_endian, _format>::store_value;
   using DST_VALUES<_endian, _format>::i_dst;
 
+  constexpr static size_t WIDE{64}; /**< Longest COPY1/17/33/49 */
+
   explicit RLE(const Properties::Metadata *_metadata)
-      : DST_VALUES<_endian, _format>(_metadata) {}
+      : DST_VALUES<_endian, _format>(_metadata, WIDE) {}
 
+  /**
+   *  The commands are decoded with raw pointers and the bounds are checked
+   *  once per command.  The destination is padded with WIDE bytes: the
+   *  short runs and copies are written with fixed size (vectorized) stores
+   *  that may spill over the end of the run.  The spilled bytes are
+   *  overwritten by the next commands or by the final zero fill.  As for
+   *  RDC, the decompression stops after the n_stop first bytes.
+   */
   BYTES operator()(const BYTES &_values) {
+    return (*this)(_values, buf.data(0, n_dst + WIDE));
+  }
+
+  /// Decompress _values into _dst, followed by at least WIDE bytes.
+  BYTES operator()(const BYTES &_values, uint8_t *_dst) {
     constexpr uint8_t FOUR{4}, EIGHT{8};
 
     reset();
-    SRC_VALUES src(_values);
-    auto store_values = [&](size_t n) {
-      n = std::min(n, src.remaining());
-      assert_check(n);
-      buf.copy(i_dst, src.pop(n));
-      i_dst += n;
+    const uint8_t *s = _values.data();
+    const uint8_t *const s_end = s + _values.size();
+    uint8_t *const d_begin = _dst;
+    uint8_t *d = d_begin;
+    uint8_t *const d_end = d_begin + n_dst;
+    uint8_t *const d_stop = d_begin + n_stop;
+
+    auto check_room = [&](const size_t _n) {
+      if constexpr (_assert == ASSERT::YES) {
+        if (_n > static_cast<size_t>(d_end - d)) {
+          i_dst = static_cast<size_t>(d - d_begin);
+          assert_check(_n);
+        }
+      }
+    };
+    auto copy_values = [&](size_t _n) {
+      const auto remaining = static_cast<size_t>(s_end - s);
+      _n = std::min(_n, remaining);
+      check_room(_n);
+      // Only the source bytes can be read
+      if (_n <= 16 && remaining >= 16)
+        std::memcpy(d, s, 16);
+      else if (_n <= WIDE && remaining >= WIDE)
+        std::memcpy(d, s, WIDE);
+      else
+        std::memcpy(d, s, _n);
+      d += _n;
+      s += _n;
+    };
+    auto insert_value = [&](const uint8_t _v, const size_t _n) {
+      check_room(_n);
+      if (_n <= WIDE)
+        std::memset(d, _v, WIDE);
+      else
+        std::memset(d, _v, _n);
+      d += _n;
     };
 
-    while (src.check(2) && check()) {
-      const auto val = src.pop();
+    while (s_end - s >= 2 && d < d_stop) {
+      const auto val = *s++;
       const uint8_t command = static_cast<uint8_t>(val >> FOUR);
       const size_t end_of_first_byte = static_cast<size_t>(val & 0x0F);
-      D(spdlog::info("RLE:({}, {}: {:#X})\n", src.i_src, i_dst, command));
+      D(spdlog::info("RLE:({}, {}: {:#X})\n", s - _values.data(), d - d_begin,
+                     command));
       switch (command) {
-        break;
       case SAS_RLE_COMMAND_COPY64: {
-        const size_t n = (end_of_first_byte << EIGHT) + src.pop() + 64;
-        store_values(n);
+        const size_t n = (end_of_first_byte << EIGHT) + *s++ + 64;
+        copy_values(n);
       } break;
       case SAS_RLE_COMMAND_INSERT_BYTE18: {
-        const size_t n = (end_of_first_byte << FOUR) + src.pop() + 18;
-        store_value(src.pop(), n);
+        // Truncated command: stop as for the other incomplete commands.
+        if (s_end - s < 2) {
+          s = s_end;
+          break;
+        }
+        const size_t n = (end_of_first_byte << FOUR) + *s++ + 18;
+        insert_value(*s++, n);
       } break;
       case SAS_RLE_COMMAND_INSERT_AT17: {
-        const size_t n = (end_of_first_byte << EIGHT) + src.pop() + 17;
-        store_value(C_AT, n);
+        const size_t n = (end_of_first_byte << EIGHT) + *s++ + 17;
+        insert_value(C_AT, n);
       } break;
       case SAS_RLE_COMMAND_INSERT_BLANK17: {
-        const size_t n = (end_of_first_byte << EIGHT) + src.pop() + 17;
-        store_value(C_SPACE, n);
+        const size_t n = (end_of_first_byte << EIGHT) + *s++ + 17;
+        insert_value(C_SPACE, n);
       } break;
       case SAS_RLE_COMMAND_INSERT_ZERO17: {
-        const size_t n = (end_of_first_byte << EIGHT) + src.pop() + 17;
-        store_value(C_NULL, n);
+        const size_t n = (end_of_first_byte << EIGHT) + *s++ + 17;
+        insert_value(C_NULL, n);
       } break;
       case SAS_RLE_COMMAND_COPY1: {
-        store_values(end_of_first_byte + 1);
+        copy_values(end_of_first_byte + 1);
       } break;
       case SAS_RLE_COMMAND_COPY17: {
-        store_values(end_of_first_byte + 17);
+        copy_values(end_of_first_byte + 17);
       } break;
       case SAS_RLE_COMMAND_COPY33: {
-        store_values(end_of_first_byte + 33);
+        copy_values(end_of_first_byte + 33);
       } break;
       case SAS_RLE_COMMAND_COPY49: {
-        store_values(end_of_first_byte + 49);
+        copy_values(end_of_first_byte + 49);
       } break;
       case SAS_RLE_COMMAND_INSERT_BYTE3: {
-        store_value(src.pop(), end_of_first_byte + 3);
+        insert_value(*s++, end_of_first_byte + 3);
       } break;
       case SAS_RLE_COMMAND_INSERT_AT2: {
-        store_value(C_AT, end_of_first_byte + 2);
+        insert_value(C_AT, end_of_first_byte + 2);
       } break;
       case SAS_RLE_COMMAND_INSERT_BLANK2: {
-        store_value(C_SPACE, end_of_first_byte + 2);
+        insert_value(C_SPACE, end_of_first_byte + 2);
       } break;
       case SAS_RLE_COMMAND_INSERT_ZERO2: {
-        store_value(C_NULL, end_of_first_byte + 2);
+        insert_value(C_NULL, end_of_first_byte + 2);
       } break;
       default: {
         spdlog::critical("Invalid command: {:#X} at offset {}\n", command,
-                         (src.i_src - 1));
+                         (s - _values.data() - 1));
         EXCEPTION::cannot_decompress();
       }
       }
     }
-    fill();
-    return buf.as_bytes();
+    std::memset(d, C_NULL, static_cast<size_t>(d_end - d));
+    i_dst = n_dst;
+    return INTERNAL::get_bytes(d_begin, n_dst);
   }
 };
 
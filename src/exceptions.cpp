@@ -25,6 +25,14 @@ void EXCEPTION::not_a_valid_file(const char *_pcszFileName) {
   raise_exception(fmt::format("not_a_valid_file: [{}]", _pcszFileName));
 }
 
+void EXCEPTION::cannot_map_file(const char *_pcszFileName) {
+  raise_exception(fmt::format("cannot_map_file: [{}]", _pcszFileName));
+}
+
+void EXCEPTION::cannot_write_file(const char *_pcszFileName) {
+  raise_exception(fmt::format("cannot_write_file: [{}]", _pcszFileName));
+}
+
 void EXCEPTION::header_too_short() { raise_exception("header_too_short"); }
 
 void EXCEPTION::invalid_magic_number() {
@@ -40,4 +48,13 @@ void EXCEPTION::invalid_buffer_access(const size_t _offset, const size_t _n,
   raise_exception(
       fmt::format("invalid_buffer_access: {}+{}>{}", _offset, _n, _size));
 }
+
+void EXCEPTION::unknown_column(const char *_pcszColumnName) {
+  raise_exception(fmt::format("unknown_column: [{}]", _pcszColumnName));
+}
+
+void EXCEPTION::row_filter_type_mismatch(const char *_pcszColumnName) {
+  raise_exception(
+      fmt::format("row_filter_type_mismatch: [{}]", _pcszColumnName));
+}
 } // namespace cppsas7bdat
@@ -15,12 +15,16 @@ namespace cppsas7bdat {
 namespace EXCEPTION {
 void cannot_allocate_memory();
 void not_a_valid_file(const char *_pcszFileName);
+void cannot_map_file(const char *_pcszFileName);
+void cannot_write_file(const char *_pcszFileName);
 void header_too_short();
 void invalid_magic_number();
 void cannot_read_page();
 void cannot_decompress();
 void invalid_buffer_access(const size_t _offset, const size_t _n,
                            const size_t _size);
+void unknown_column(const char *_pcszColumnName);
+void row_filter_type_mismatch(const char *_pcszColumnName);
 } // namespace EXCEPTION
 } // namespace cppsas7bdat
 
@@ -9,8 +9,12 @@
 #ifndef _CPP_SAS7BDAT_SRC_FORMATTERS_HPP_
 #define _CPP_SAS7BDAT_SRC_FORMATTERS_HPP_
 
+#include "byteswap.hpp"
+#include "missing.hpp"
+#include <algorithm>
 #include <limits>
 #include <string>
+#include <type_traits>
 
 namespace cppsas7bdat {
 namespace INTERNAL {
@@ -18,10 +22,14 @@ namespace FORMATTER {
 
 using Type = Column::Type;
 
+using Op = Column::Op;
+
 struct IFormatter {
   const size_t offset{0};
   const size_t length{0};
   const Type type{Type::unknown};
+  constexpr static Op op{Op::none}; /**< See DecodePlan */
+  constexpr static Endian endian{Endian::unknown};
 
   IFormatter(const size_t _offset, const size_t _length, const Type _type)
       : offset(_offset), length(_length), type(_type) {}
@@ -40,12 +48,88 @@ struct IFormatter {
   TIME get_time([[maybe_unused]] const void *_p) const noexcept {
     return TIME(boost::posix_time::not_a_date_time);
   }
+  EPOCH get_epoch([[maybe_unused]] const void *_p) const noexcept {
+    return EPOCH_NA;
+  }
   STRING to_string([[maybe_unused]] const void *_p) const { return {}; }
 
   const uint8_t *data(const void *_p) const noexcept {
     const uint8_t *p = reinterpret_cast<const uint8_t *>(_p) + offset;
     return p;
   }
+
+  /// Call _fct(i, p) for each row i of _rows, p pointing to the value.
+  template <typename _Fct>
+  void for_each(const RowBatch &_rows, _Fct _fct) const noexcept {
+    if (_rows.rows) {
+      for (size_t i = 0; i < _rows.count; ++i)
+        _fct(i, data(_rows.rows[i]));
+    } else {
+      const uint8_t *p = _rows.base + offset;
+      for (size_t i = 0; i < _rows.count; ++i, p += _rows.stride)
+        _fct(i, p);
+    }
+  }
+
+  /// Convert the _Tp values stored with the endianness _endian into _out,
+  /// in one pass when the rows are contiguous (see INTERNAL::get_vals).
+  template <Endian _endian, typename _Tp, typename _Out>
+  void get_vals(const RowBatch &_rows, _Out *_out) const noexcept {
+    if (_rows.rows)
+      for_each(_rows, [&](const size_t _i, const uint8_t *_p) {
+        INTERNAL::get_vals<_endian, _Tp>(_p, sizeof(_Tp), 1, _out + _i);
+      });
+    else
+      INTERNAL::get_vals<_endian, _Tp>(_rows.base + offset, _rows.stride,
+                                       _rows.count, _out);
+  }
+
+  void get_strings(const RowBatch &_rows, SV *_out) const noexcept {
+    std::fill_n(_out, _rows.count, SV{});
+  }
+  void get_numbers(const RowBatch &_rows, NUMBER *_out) const noexcept {
+    std::fill_n(_out, _rows.count, std::numeric_limits<NUMBER>::quiet_NaN());
+  }
+  void get_integers(const RowBatch &_rows, INTEGER *_out) const noexcept {
+    std::fill_n(_out, _rows.count, INTEGER{});
+  }
+  void get_epochs(const RowBatch &_rows, EPOCH *_out) const noexcept {
+    std::fill_n(_out, _rows.count, EPOCH_NA);
+  }
+  void get_validity(const RowBatch &_rows, uint8_t *_validity,
+                    char *_codes) const noexcept {
+    set_all_valid(_rows.count, _validity, _codes);
+  }
+
+protected:
+  /// Call _fct(i, rows) for the consecutive slices of at most _block rows.
+  template <size_t _block, typename _Fct>
+  static void for_each_block(const RowBatch &_rows, _Fct _fct) noexcept {
+    for (size_t i = 0; i < _rows.count; i += _block) {
+      RowBatch rows = _rows;
+      rows.first_row = _rows.first_row + i;
+      rows.count = std::min(_block, _rows.count - i);
+      if (_rows.rows)
+        rows.rows = _rows.rows + i;
+      else
+        rows.base = _rows.base + i * _rows.stride;
+      _fct(i, rows);
+    }
+  }
+
+  /// Validity of the numbers of _formatter, by blocks.
+  template <typename _Formatter>
+  static void get_number_validity(const _Formatter &_formatter,
+                                  const RowBatch &_rows, uint8_t *_validity,
+                                  char *_codes) noexcept {
+    constexpr size_t block = 256;
+    NUMBER buf[block];
+    for_each_block<block>(_rows, [&](const size_t _i, const RowBatch &_block) {
+      _formatter.get_numbers(_block, buf);
+      INTERNAL::get_validity(buf, _block.count, _validity + _i / 8,
+                             _codes ? _codes + _i : nullptr);
+    });
+  }
 };
 
 struct NoFormatter : public IFormatter {
@@ -56,6 +140,8 @@ struct NoFormatter : public IFormatter {
 };
 
 struct StringFormatter : public IFormatter {
+  constexpr static Op op{Op::string};
+
   StringFormatter(const size_t _offset, const size_t _length)
       : IFormatter(_offset, _length, Type::string) {
     D(spdlog::debug("StringFormatter\n"));
@@ -65,10 +151,18 @@ struct StringFormatter : public IFormatter {
     return INTERNAL::get_string_trim_0(data(_p), length);
   }
 
+  void get_strings(const RowBatch &_rows, SV *_out) const noexcept {
+    for_each(_rows, [&](const size_t _i, const uint8_t *_p) {
+      _out[_i] = INTERNAL::get_string_trim_0(_p, length);
+    });
+  }
+
   STRING to_string(const void *_p) const { return STRING(get_string(_p)); }
 };
 
 struct SmallIntegerFormatter : public IFormatter {
+  constexpr static Op op{Op::uint8};
+
   SmallIntegerFormatter(const size_t _offset, const size_t _length)
       : IFormatter(_offset, _length, Type::integer) {
     D(spdlog::debug("SmallIntegerFormatter\n"));
@@ -78,6 +172,15 @@ struct SmallIntegerFormatter : public IFormatter {
 
   NUMBER get_number(const void *_p) const noexcept { return get_integer(_p); }
 
+  void get_integers(const RowBatch &_rows, INTEGER *_out) const noexcept {
+    for_each(_rows,
+             [&](const size_t _i, const uint8_t *_p) { _out[_i] = *_p; });
+  }
+  void get_numbers(const RowBatch &_rows, NUMBER *_out) const noexcept {
+    for_each(_rows,
+             [&](const size_t _i, const uint8_t *_p) { _out[_i] = *_p; });
+  }
+
   STRING to_string(const void *_p) const {
     return std::to_string(get_integer(_p));
   }
@@ -85,6 +188,9 @@ struct SmallIntegerFormatter : public IFormatter {
 
 template <Endian _endian, typename _Tp>
 struct IntegerFormatter : public IFormatter {
+  constexpr static Op op{std::is_same_v<_Tp, int16_t> ? Op::int16 : Op::none};
+  constexpr static Endian endian{_endian};
+
   IntegerFormatter(const size_t _offset, const size_t _length)
       : IFormatter(_offset, _length, Type::integer) {
     D(spdlog::debug("IntegerFormatter\n"));
@@ -96,12 +202,22 @@ struct IntegerFormatter : public IFormatter {
 
   NUMBER get_number(const void *_p) const noexcept { return get_integer(_p); }
 
+  void get_integers(const RowBatch &_rows, INTEGER *_out) const noexcept {
+    get_vals<_endian, _Tp>(_rows, _out);
+  }
+  void get_numbers(const RowBatch &_rows, NUMBER *_out) const noexcept {
+    get_vals<_endian, _Tp>(_rows, _out);
+  }
+
   STRING to_string(const void *_p) const {
     return std::to_string(get_integer(_p));
   }
 };
 
 template <Endian _endian> struct DoubleFormatter : public IFormatter {
+  constexpr static Op op{Op::number};
+  constexpr static Endian endian{_endian};
+
   DoubleFormatter(const size_t _offset, const size_t _length,
                   const Type _type = Type::number)
       : IFormatter(_offset, _length, _type) {
@@ -112,13 +228,38 @@ template <Endian _endian> struct DoubleFormatter : public IFormatter {
     return INTERNAL::get_double<_endian>(data(_p));
   }
 
+  void get_numbers(const RowBatch &_rows, NUMBER *_out) const noexcept {
+    get_vals<_endian, double>(_rows, _out);
+  }
+  void get_validity(const RowBatch &_rows, uint8_t *_validity,
+                    char *_codes) const noexcept {
+    get_number_validity(*this, _rows, _validity, _codes);
+  }
+
   STRING to_string(const void *_p) const {
     return std::to_string(get_number(_p));
   }
+
+protected:
+  /// Convert the numbers of _rows with _fct, by blocks.
+  template <typename _Fct>
+  void convert_numbers(const RowBatch &_rows, EPOCH *_out,
+                       _Fct _fct) const noexcept {
+    constexpr size_t block = 256;
+    NUMBER buf[block];
+    for_each_block<block>(_rows, [&](const size_t _i, const RowBatch &_block) {
+      get_numbers(_block, buf);
+      for (size_t j = 0; j < _block.count; ++j)
+        _out[_i + j] = _fct(buf[j]);
+    });
+  }
 };
 
 template <Endian _endian, int _nbits>
 struct IncompleteDoubleFormatter : public IFormatter {
+  constexpr static Op op{Op::number};
+  constexpr static Endian endian{_endian};
+
   IncompleteDoubleFormatter(const size_t _offset, const size_t _length)
       : IFormatter(_offset, _length, Type::number) {
     D(spdlog::debug("IncompleteDoubleFormatter\n"));
@@ -128,6 +269,20 @@ struct IncompleteDoubleFormatter : public IFormatter {
     return INTERNAL::get_incomplete_double<_endian, _nbits>(data(_p));
   }
 
+  void get_numbers(const RowBatch &_rows, NUMBER *_out) const noexcept {
+    if (_rows.rows)
+      for_each(_rows, [&](const size_t _i, const uint8_t *_p) {
+        _out[_i] = INTERNAL::get_incomplete_double<_endian, _nbits>(_p);
+      });
+    else
+      INTERNAL::get_incomplete_doubles<_endian, _nbits>(
+          _rows.base + offset, _rows.stride, _rows.count, _out);
+  }
+  void get_validity(const RowBatch &_rows, uint8_t *_validity,
+                    char *_codes) const noexcept {
+    get_number_validity(*this, _rows, _validity, _codes);
+  }
+
   STRING to_string(const void *_p) const {
     return std::to_string(get_number(_p));
   }
@@ -135,6 +290,8 @@ struct IncompleteDoubleFormatter : public IFormatter {
 
 template <Endian _endian>
 struct DateTimeFormatter : public DoubleFormatter<_endian> {
+  constexpr static Op op{Op::datetime};
+
   DateTimeFormatter(const size_t _offset, const size_t _length)
       : DoubleFormatter<_endian>(_offset, _length, Type::datetime) {
     D(spdlog::debug("DateTimeFormatter\n"));
@@ -145,6 +302,16 @@ struct DateTimeFormatter : public DoubleFormatter<_endian> {
         DoubleFormatter<_endian>::get_number(_p));
   }
 
+  /// Microseconds since 1970-01-01.
+  EPOCH get_epoch(const void *_p) const noexcept {
+    return INTERNAL::get_unix_microseconds(
+        DoubleFormatter<_endian>::get_number(_p));
+  }
+  void get_epochs(const RowBatch &_rows, EPOCH *_out) const noexcept {
+    DoubleFormatter<_endian>::convert_numbers(
+        _rows, _out, INTERNAL::get_unix_microseconds);
+  }
+
   DATE get_date([[maybe_unused]] const void *_p) const noexcept {
     return get_datetime(_p).date();
   }
@@ -161,6 +328,8 @@ struct DateTimeFormatter : public DoubleFormatter<_endian> {
 
 template <Endian _endian>
 struct DateFormatter : public DoubleFormatter<_endian> {
+  constexpr static Op op{Op::date};
+
   DateFormatter(const size_t _offset, const size_t _length)
       : DoubleFormatter<_endian>(_offset, _length, Type::date) {
     D(spdlog::debug("DateTimeFormatter\n"));
@@ -171,6 +340,15 @@ struct DateFormatter : public DoubleFormatter<_endian> {
         DoubleFormatter<_endian>::get_number(_p));
   }
 
+  /// Days since 1970-01-01.
+  EPOCH get_epoch(const void *_p) const noexcept {
+    return INTERNAL::get_unix_days(DoubleFormatter<_endian>::get_number(_p));
+  }
+  void get_epochs(const RowBatch &_rows, EPOCH *_out) const noexcept {
+    DoubleFormatter<_endian>::convert_numbers(_rows, _out,
+                                              INTERNAL::get_unix_days);
+  }
+
   DATETIME get_datetime([[maybe_unused]] const void *_p) const noexcept {
     return DATETIME(get_date(_p), {});
   }
@@ -185,6 +363,8 @@ struct DateFormatter : public DoubleFormatter<_endian> {
 
 template <Endian _endian>
 struct TimeFormatter : public DoubleFormatter<_endian> {
+  constexpr static Op op{Op::time};
+
   TimeFormatter(const size_t _offset, const size_t _length)
       : DoubleFormatter<_endian>(_offset, _length, Type::time) {
     D(spdlog::debug("DateTimeFormatter\n"));
@@ -195,6 +375,16 @@ struct TimeFormatter : public DoubleFormatter<_endian> {
         DoubleFormatter<_endian>::get_number(_p));
   }
 
+  /// Microseconds since midnight.
+  EPOCH get_epoch(const void *_p) const noexcept {
+    return INTERNAL::get_day_microseconds(
+        DoubleFormatter<_endian>::get_number(_p));
+  }
+  void get_epochs(const RowBatch &_rows, EPOCH *_out) const noexcept {
+    DoubleFormatter<_endian>::convert_numbers(
+        _rows, _out, INTERNAL::get_day_microseconds);
+  }
+
   DATETIME get_datetime([[maybe_unused]] const void *_p) const noexcept {
     return DATETIME({}, get_time(_p));
   }
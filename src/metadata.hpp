@@ -11,6 +11,7 @@
 
 #include "formatters.hpp"
 #include "page.hpp"
+#include <deque>
 
 namespace cppsas7bdat {
 namespace INTERNAL {
@@ -114,10 +115,12 @@ struct READ_METADATA : public READ_PAGE<_DataSource, _endian, _format>,
   static constexpr const char RDC_COMPRESSION[] = "SASYZCR2";
 
   DATASUBHEADERS data_subheaders;
-  std::vector<std::string> column_texts;
-  std::vector<std::string> column_names;
-  std::vector<std::string> column_formats;
-  std::vector<std::string> column_labels;
+  // The names, formats and labels point into the column texts: a deque
+  // keeps them in place when a text is added.
+  std::deque<std::string> column_texts;
+  std::vector<std::string_view> column_names;
+  std::vector<std::string_view> column_formats;
+  std::vector<std::string_view> column_labels;
   std::vector<size_t> column_data_offsets;
   std::vector<size_t> column_data_lengths;
   std::vector<Column::Type> column_data_types;
@@ -300,20 +303,21 @@ struct READ_METADATA : public READ_PAGE<_DataSource, _endian, _format>,
     }
   }
 
-  std::string get_column_text_substr(const size_t _idx, size_t _offset,
-                                     size_t _length) const noexcept {
+  std::string_view get_column_text_substr(const size_t _idx, size_t _offset,
+                                          size_t _length) const noexcept {
     if (_idx < column_texts.size()) {
-      const auto ct = column_texts[std::min(_idx, column_texts.size() - 1)];
+      const std::string_view ct = column_texts[_idx];
       const auto n = ct.size();
       _offset = std::min(_offset, n);
       _length = std::min(_length, n - _offset);
-      if (_length && std::isprint(ct[_offset])) {
-        while (_length && std::isspace(ct[_offset])) {
+      auto c = [&](const size_t _i) { return static_cast<uint8_t>(ct[_i]); };
+      if (_length && is_print(c(_offset))) {
+        while (_length && is_space(c(_offset))) {
           ++_offset;
           --_length;
         }
-        while (_length && (!std::isprint(ct[_offset + _length - 1]) ||
-                           std::isspace(ct[_offset + _length - 1]))) {
+        while (_length && (!is_print(c(_offset + _length - 1)) ||
+                           is_space(c(_offset + _length - 1)))) {
           --_length;
         }
         return ct.substr(_offset, _length);
@@ -413,12 +417,19 @@ struct READ_METADATA : public READ_PAGE<_DataSource, _endian, _format>,
     const size_t ncols = _metadata->column_count;
     _metadata->columns.reserve(ncols);
 
-    auto get_value = [&](auto arg, auto vals, const size_t icol) {
-      const auto n = std::min(ncols, vals.size());
-      if (n != ncols)
+    auto check_count = [&](auto arg, const auto &vals) {
+      if (vals.size() < ncols)
         spdlog::info("Mismatch between the expected number of columns ({}) and "
                      "the number ({}) of '{}' values!\n",
                      ncols, vals.size(), arg);
+    };
+    check_count("name", column_names);
+    check_count("label", column_labels);
+    check_count("format", column_formats);
+    check_count("data_offset", column_data_offsets);
+    check_count("data_length", column_data_lengths);
+    check_count("data_type", column_data_types);
+    auto get_value = [](const auto &vals, const size_t icol) {
       return vals.at(icol);
     };
 
@@ -426,14 +437,16 @@ struct READ_METADATA : public READ_PAGE<_DataSource, _endian, _format>,
 
     for (size_t icol = 0; icol < ncols; ++icol) {
       D(spdlog::info("READ_METADATA::create_columns: {}/{}\n", icol, ncols));
-      const auto column_name = get_value("name", column_names, icol);
-      const auto column_label = get_value("label", column_labels, icol);
-      const auto column_format = get_value("format", column_formats, icol);
-      const auto column_offset =
-          get_value("data_offset", column_data_offsets, icol);
-      const auto column_length =
-          get_value("data_length", column_data_lengths, icol);
-      const auto column_type = get_value("data_type", column_data_types, icol);
+      const auto column_name = get_value(column_names, icol);
+      // The filters which only need the name skip the column before its
+      // formatter is created.
+      if (_filter && _filter->accept(column_name) == false)
+        continue;
+      const auto column_label = get_value(column_labels, icol);
+      const auto column_format = get_value(column_formats, icol);
+      const auto column_offset = get_value(column_data_offsets, icol);
+      const auto column_length = get_value(column_data_lengths, icol);
+      const auto column_type = get_value(column_data_types, icol);
 
       bool column_type_not_supported = true;
       auto add_column = [&](auto &&formatter) {
@@ -442,7 +455,8 @@ struct READ_METADATA : public READ_PAGE<_DataSource, _endian, _format>,
                        column_length, column_type));
         column_type_not_supported = false;
 
-        Column column(column_name, column_label, column_format,
+        Column column(std::string(column_name), std::string(column_label),
+                      std::string(column_format),
                       std::forward<decltype(formatter)>(formatter));
         if (!_filter || _filter->accept(column))
           _metadata->columns.emplace_back(
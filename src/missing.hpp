@@ -0,0 +1,103 @@
+/**
+ *  \file src/missing.hpp
+ *
+ *  \brief Validity bitmaps and SAS missing value codes
+ *
+ *  \author Olivia Quinet
+ */
+
+#ifndef _CPP_SAS7BDAT_SRC_MISSING_HPP_
+#define _CPP_SAS7BDAT_SRC_MISSING_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cppsas7bdat/types.hpp>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace cppsas7bdat {
+namespace INTERNAL {
+
+/**
+ *  Code of the SAS missing value _x (a NaN): '.', 'A' to 'Z' or '_'.
+ *
+ *  The code is stored complemented in the byte below the exponent:
+ *  0xFF for '_', 0xFE for '.' and 0xFD to 0xE4 for 'A' to 'Z'.  This byte
+ *  is kept by the truncated doubles.
+ */
+inline char get_missing_code(const NUMBER _x) noexcept {
+  uint64_t bits;
+  std::memcpy(&bits, &_x, sizeof(bits));
+  const auto tag = static_cast<uint8_t>(~(bits >> 40));
+  if (tag == 0)
+    return '_';
+  if (tag >= 2 && tag < 28)
+    return static_cast<char>('A' + (tag - 2));
+  return '.';
+}
+
+/// Set the bits of the _n values in _validity and clear the codes.
+inline void set_all_valid(const size_t _n, uint8_t *_validity,
+                          char *_codes) noexcept {
+  std::fill_n(_validity, _n / 8, uint8_t{0xFF});
+  if (_n % 8)
+    _validity[_n / 8] = static_cast<uint8_t>((1u << (_n % 8)) - 1);
+  if (_codes)
+    std::fill_n(_codes, _n, '\0');
+}
+
+/**
+ *  Bitmap of the values of _x which are not missing (NaN) in _validity, one
+ *  bit per value starting with the least significant bit, the bits past
+ *  _n cleared.  If _codes is not null, _codes[i] is the missing value code
+ *  of _x[i] (see get_missing_code) or 0.
+ *
+ *  With SSE2, 8 values are compared at once; the codes are only decoded
+ *  for the missing values.
+ */
+inline void get_validity(const NUMBER *_x, const size_t _n, uint8_t *_validity,
+                         char *_codes) noexcept {
+  auto set = [&](const size_t _i, const unsigned _missing, const size_t _m) {
+    _validity[_i / 8] =
+        static_cast<uint8_t>(~_missing & ((1u << _m) - 1));
+    if (!_codes)
+      return;
+    std::fill_n(_codes + _i, _m, '\0');
+    for (unsigned m = _missing; m; m &= m - 1) {
+      const auto j = static_cast<size_t>(std::countr_zero(m));
+      _codes[_i + j] = get_missing_code(_x[_i + j]);
+    }
+  };
+  size_t i = 0;
+  for (; i + 8 <= _n; i += 8) {
+#if defined(__SSE2__)
+    auto nan = [&](const size_t _j) {
+      const auto x = _mm_loadu_pd(_x + i + _j);
+      return static_cast<unsigned>(_mm_movemask_pd(_mm_cmpunord_pd(x, x)))
+             << _j;
+    };
+    set(i, nan(0) | nan(2) | nan(4) | nan(6), 8);
+#else
+    unsigned missing = 0;
+    for (size_t j = 0; j < 8; ++j)
+      missing |= static_cast<unsigned>(std::isnan(_x[i + j])) << j;
+    set(i, missing, 8);
+#endif
+  }
+  if (i < _n) {
+    unsigned missing = 0;
+    for (size_t j = 0; i + j < _n; ++j)
+      missing |= static_cast<unsigned>(std::isnan(_x[i + j])) << j;
+    set(i, missing, _n - i);
+  }
+}
+
+} // namespace INTERNAL
+} // namespace cppsas7bdat
+
+#endif
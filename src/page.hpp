@@ -77,6 +77,7 @@ struct READ_PAGE : public PAGE_CONSTANT<_format> {
       subheaders_count = 0;
     }
   } current_page_header;
+  size_t page_index{0}; /**< Index of the next page to read */
 
   READ_PAGE(_DataSource &&_is, INTERNAL::BUFFER<_endian, _format> &&_buf,
             const Properties::Header *_header)
@@ -84,7 +85,8 @@ struct READ_PAGE : public PAGE_CONSTANT<_format> {
 
   READ_PAGE(READ_PAGE<_DataSource, _endian, _format> &&_rp)
       : is(std::move(_rp.is)), buf(std::move(_rp.buf)), header(_rp.header),
-        current_page_header(_rp.current_page_header) {}
+        current_page_header(_rp.current_page_header),
+        page_index(_rp.page_index) {}
 
   void set_pheader(const Properties::Header *_header) { header = _header; }
 
@@ -99,20 +101,84 @@ struct READ_PAGE : public PAGE_CONSTANT<_format> {
         return false;
       EXCEPTION::cannot_read_page();
     }
+    ++page_index;
     return _get_page_header();
   }
 
+  /// Read only the header of the page _ipage, and its subheader pointers
+  /// for the meta/mix pages, into _buf.  The data source must be seekable.
+  bool peek_page(const size_t _ipage, BUFFER &_buf,
+                 PAGE_HEADER &_page_header) {
+    const size_t position = page_offset(_ipage);
+    const size_t length = page_bit_offset + 8;
+    if (!_buf.read_stream_at(is, length, position))
+      return false;
+    get_page_header(_buf, _page_header);
+    if (!is_page_meta_mix_amd(_page_header.type))
+      return true;
+    const size_t pointers_length =
+        length + _page_header.subheaders_count * subheader_size();
+    if (pointers_length > header->page_length)
+      return false;
+    return _buf.read_stream_at(is, pointers_length, position);
+  }
+
+  size_t page_offset(const size_t _ipage) const noexcept {
+    return header->header_length + _ipage * header->page_length;
+  }
+
+  /// Number of pages in the data source or 0 if it is not seekable.
+  size_t page_count() const {
+    if (!is->is_seekable() || header->page_length == 0)
+      return 0;
+    const size_t size = is->size();
+    return size > header->header_length
+               ? (size - header->header_length) / header->page_length
+               : 0;
+  }
+
+  /// Move to the page _ipage without reading the pages in between if the
+  /// data source is seekable.
+  bool seek_page(const size_t _ipage) {
+    if (_ipage == page_index)
+      return true;
+    if (is->is_seekable()) {
+      if (!is->seek(page_offset(_ipage)))
+        return false;
+      page_index = _ipage;
+      return true;
+    }
+    // Otherwise, the pages can only be read forward.
+    while (page_index < _ipage) {
+      if (!read_page())
+        return false;
+    }
+    return page_index == _ipage;
+  }
+
+  /// Read the page _ipage, i.e. the page at header_length + _ipage *
+  /// page_length.
+  bool read_page(const size_t _ipage) {
+    if (!seek_page(_ipage))
+      return false;
+    return read_page();
+  }
+
   bool _get_page_header() {
     D(spdlog::info("get_page_header: "));
-    current_page_header.type = buf.get_uint16(page_bit_offset + 0);
-    current_page_header.block_count = buf.get_uint16(page_bit_offset + 2);
-    current_page_header.subheaders_count = buf.get_uint16(page_bit_offset + 4);
+    get_page_header(buf, current_page_header);
     D(spdlog::info("{},{},{}\n", current_page_header.type,
                    current_page_header.block_count,
                    current_page_header.subheaders_count));
     return true;
   }
 
+  static void get_page_header(const BUFFER &_buf, PAGE_HEADER &_page_header) {
+    _page_header.type = _buf.get_uint16(page_bit_offset + 0);
+    _page_header.block_count = _buf.get_uint16(page_bit_offset + 2);
+    _page_header.subheaders_count = _buf.get_uint16(page_bit_offset + 4);
+  }
+
   constexpr static size_t subheader_size() noexcept {
     return 3 * integer_size; // 12 or 24
   }
@@ -136,15 +202,22 @@ struct READ_PAGE : public PAGE_CONSTANT<_format> {
   }
 
   PAGE_SUBHEADER _get_page_subheader(const size_t _offset) const {
-    buf.assert_check(_offset, subheader_size());
-    const auto offset = buf.get_uinteger(_offset);
-    const auto length = buf.get_uinteger(_offset + integer_size);
-    const auto compression = buf.get_byte(_offset + integer_size * 2);
-    const auto type = buf.get_byte(_offset + integer_size * 2 + 1);
+    const auto subheader = get_page_subheader_pointer(buf, _offset);
     D(spdlog::info("soffset={}, slength={}, scompression={}, stype:{}\n",
-                   offset, length, compression, type));
+                   subheader.offset, subheader.length, subheader.compression,
+                   subheader.type));
     // Check that the corresponding subheader falls within the buffer
-    buf.assert_check(offset, length);
+    buf.assert_check(subheader.offset, subheader.length);
+    return subheader;
+  }
+
+  static PAGE_SUBHEADER get_page_subheader_pointer(const BUFFER &_buf,
+                                                   const size_t _offset) {
+    _buf.assert_check(_offset, subheader_size());
+    const auto offset = _buf.get_uinteger(_offset);
+    const auto length = _buf.get_uinteger(_offset + integer_size);
+    const auto compression = _buf.get_byte(_offset + integer_size * 2);
+    const auto type = _buf.get_byte(_offset + integer_size * 2 + 1);
     return PAGE_SUBHEADER{offset, length, compression, type};
   }
 };
@@ -0,0 +1,155 @@
+/**
+ *  \file src/page_index.cpp
+ *
+ *  \brief Page index
+ *
+ *  \author Olivia Quinet
+ */
+
+#include "exceptions.hpp"
+#include <algorithm>
+#include <cppsas7bdat/page_index.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace cppsas7bdat {
+
+namespace {
+constexpr char MAGIC[8] = {'S', 'A', 'S', '7', 'B', 'I', 'D', 'X'};
+constexpr uint32_t VERSION{1};
+// Written in the native byte order: detects a sidecar from another platform.
+constexpr uint32_t ENDIANNESS_MARK{0x01020304};
+
+bool get_file_stamp(const char *_pcszfilename, uint64_t &_size,
+                    int64_t &_mtime) {
+  std::error_code ec;
+  const std::filesystem::path path(_pcszfilename);
+  const auto size = std::filesystem::file_size(path, ec);
+  if (ec)
+    return false;
+  const auto mtime = std::filesystem::last_write_time(path, ec);
+  if (ec)
+    return false;
+  _size = size;
+  _mtime = mtime.time_since_epoch().count();
+  return true;
+}
+
+template <typename _Tp> void write(std::ofstream &_os, const _Tp &_value) {
+  _os.write(reinterpret_cast<const char *>(&_value), sizeof(_Tp));
+}
+
+template <typename _Tp> bool read(std::ifstream &_is, _Tp &_value) {
+  _is.read(reinterpret_cast<char *>(&_value), sizeof(_Tp));
+  return _is.good();
+}
+} // namespace
+
+size_t PageIndex::find(const size_t _row) const noexcept {
+  // First page starting after _row...
+  auto it = std::upper_bound(
+      pages.begin(), pages.end(), _row,
+      [](const size_t _r, const Page &_page) { return _r < _page.first_row; });
+  // ... and go back to the page holding _row, i.e. skipping the empty pages.
+  while (it != pages.begin()) {
+    --it;
+    if (_row < it->first_row + it->row_count)
+      return static_cast<size_t>(it - pages.begin());
+    if (it->row_count)
+      break;
+  }
+  return pages.size();
+}
+
+std::vector<PageIndex::Partition>
+PageIndex::partitions(const size_t _count) const {
+  std::vector<Partition> parts;
+  if (pages.empty() || _count == 0)
+    return parts;
+  const auto &last = pages.back();
+  const size_t nrows = last.first_row + last.row_count;
+  parts.reserve(_count);
+  Partition part;
+  for (size_t ipage = 0; ipage < pages.size(); ++ipage) {
+    const auto &page = pages[ipage];
+    part.end_page = ipage + 1;
+    part.end_row = page.first_row + page.row_count;
+    // Close the partition once it reaches its share of the rows.
+    const size_t k = parts.size() + 1;
+    if (k < _count && part.end_row * _count >= k * nrows &&
+        part.end_row > part.first_row) {
+      parts.push_back(part);
+      part = Partition{part.end_page, part.end_page, part.end_row,
+                       part.end_row};
+    }
+  }
+  // The trailing pages without rows belong to the last partition.
+  if (part.end_row == part.first_row && !parts.empty())
+    parts.back().end_page = part.end_page;
+  else if (part.end_page > part.first_page)
+    parts.push_back(part);
+  return parts;
+}
+
+void PageIndex::save(const char *_pcszsidecar,
+                     const char *_pcszfilename) const {
+  uint64_t size{0};
+  int64_t mtime{0};
+  if (!get_file_stamp(_pcszfilename, size, mtime))
+    EXCEPTION::not_a_valid_file(_pcszfilename);
+  std::ofstream os(_pcszsidecar, std::ios::binary | std::ios::trunc);
+  if (!os)
+    EXCEPTION::cannot_write_file(_pcszsidecar);
+  os.write(MAGIC, sizeof(MAGIC));
+  write(os, VERSION);
+  write(os, ENDIANNESS_MARK);
+  write(os, size);
+  write(os, mtime);
+  const uint64_t npages = pages.size();
+  write(os, npages);
+  for (const auto &page : pages) {
+    write(os, page.offset);
+    write(os, page.type);
+    write(os, page.first_row);
+    write(os, page.row_count);
+  }
+  if (!os.good())
+    EXCEPTION::cannot_write_file(_pcszsidecar);
+}
+
+std::optional<PageIndex> PageIndex::load(const char *_pcszsidecar,
+                                         const char *_pcszfilename) {
+  std::ifstream is(_pcszsidecar, std::ios::binary);
+  if (!is)
+    return {};
+  char magic[sizeof(MAGIC)];
+  uint32_t version{0}, byte_order{0};
+  PageIndex index;
+  uint64_t npages{0};
+  is.read(magic, sizeof(magic));
+  if (!is.good() || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      !read(is, version) || version != VERSION || !read(is, byte_order) ||
+      byte_order != ENDIANNESS_MARK || !read(is, index.file_size) ||
+      !read(is, index.file_mtime) || !read(is, npages))
+    return {};
+
+  // The index is only valid for the very same file.
+  uint64_t size{0};
+  int64_t mtime{0};
+  if (!get_file_stamp(_pcszfilename, size, mtime) || size != index.file_size ||
+      mtime != index.file_mtime)
+    return {};
+
+  index.pages.reserve(static_cast<size_t>(std::min<uint64_t>(npages, size)));
+  for (uint64_t ipage = 0; ipage < npages; ++ipage) {
+    Page page;
+    if (!read(is, page.offset) || !read(is, page.type) ||
+        !read(is, page.first_row) || !read(is, page.row_count))
+      return {};
+    index.pages.push_back(page);
+  }
+  return index;
+}
+
+} // namespace cppsas7bdat
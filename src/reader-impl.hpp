@@ -20,25 +20,83 @@ class Reader::impl : public boost::noncopyable {
 public:
   static PIMPL build(PSOURCE &&_source, PSINK &&_sink, PFILTER &&_filter);
 
-  explicit impl(PSINK &&_sink, Properties &&_properties)
+  using PPROPERTIES = std::shared_ptr<const Properties>;
+  using PCROWFILTER = std::shared_ptr<const RowFilterConcept>;
+
+  explicit impl(PSINK &&_sink, PPROPERTIES &&_properties)
       : m_sink(std::move(_sink)), m_properties(std::move(_properties)) {
     m_sink->set_properties(properties());
   }
   virtual ~impl() {}
 
-  const Properties &properties() const noexcept { return m_properties; }
+  const Properties &properties() const noexcept { return *m_properties; }
+  const PPROPERTIES &shared_properties() const noexcept {
+    return m_properties;
+  }
 
   virtual size_t current_row_index() const noexcept = 0;
 
+  void set_row_filter(PROWFILTER &&_filter) {
+    if (_filter) {
+      if (const auto error = _filter->bind(properties().columns)) {
+        if (error->reason == RowFilter::BindError::Reason::type_mismatch)
+          EXCEPTION::row_filter_type_mismatch(error->column.c_str());
+        else
+          EXCEPTION::unknown_column(error->column.c_str());
+      }
+    }
+    m_row_filter = std::move(_filter);
+  }
+
+  const PCROWFILTER &row_filter() const noexcept { return m_row_filter; }
+  void set_row_filter(const PCROWFILTER &_filter) { m_row_filter = _filter; }
+
   void push_row(const size_t _row_index, Column::PBUF _p) {
+    if (m_row_filter && !m_row_filter->accept(_p))
+      return;
     m_sink->push_row(_row_index, _p);
   }
 
+  void push_rows(const RowBatch &_rows) {
+    if (!m_row_filter) {
+      m_sink->push_rows(_rows);
+      return;
+    }
+    m_selected.resize(_rows.size());
+    const auto n = m_row_filter->select(_rows, m_selected.data());
+    if (n == _rows.size()) {
+      m_sink->push_rows(_rows);
+      return;
+    }
+    // Push the runs of consecutive rows accepted.
+    for (size_t i = 0; i < n;) {
+      const auto first = m_selected[i];
+      size_t count = 1;
+      while (i + count < n && m_selected[i + count] == first + count)
+        ++count;
+      RowBatch rows{_rows.first_row + first, count, nullptr, nullptr,
+                    _rows.stride};
+      if (_rows.rows)
+        rows.rows = _rows.rows + first;
+      else
+        rows.base = _rows.base + first * _rows.stride;
+      m_sink->push_rows(rows);
+      i += count;
+    }
+  }
+
   void end_of_data() { m_sink->end_of_data(); }
 
   virtual Column::PBUF read_row_no_sink() = 0;
 
   virtual bool skip(const size_t _nrows) = 0;
+  virtual bool seek(const size_t _row) = 0;
+
+  virtual const PageIndex &page_index() = 0;
+  virtual void set_page_index(PageIndex &&_index) = 0;
+
+  virtual PIMPL partition(PSOURCE &&_source, PSINK &&_sink,
+                          const PageIndex::Partition &_partition) = 0;
 
   virtual bool read_row() = 0;
 
@@ -48,14 +106,22 @@ public:
     return _chunk_size == 0;
   }
 
+  virtual bool read_batch() = 0;
+
+  virtual bool read_sample(const std::vector<size_t> &_rows) = 0;
+
   void read_all() {
-    while (read_row())
+    while (read_batch())
       ;
   }
 
+  virtual void read_all(const size_t _nthreads) = 0;
+
 private:
   PSINK m_sink;
-  Properties m_properties;
+  PPROPERTIES m_properties;
+  PCROWFILTER m_row_filter;
+  std::vector<size_t> m_selected; /**< Rows accepted by m_row_filter */
 };
 
 namespace INTERNAL {
@@ -63,7 +129,7 @@ namespace INTERNAL {
 template <typename _RD> class ReaderImpl : public Reader::impl {
 public:
   explicit ReaderImpl(_RD &&_rd, Reader::PSINK &&_sink,
-                      Properties &&_properties)
+                      PPROPERTIES &&_properties)
       : Reader::impl(std::move(_sink), std::move(_properties)),
         m_read_data(std::forward<_RD>(_rd)) {
     // Dirty hack to make sure to use the object's properties.
@@ -82,11 +148,66 @@ public:
     return r;
   }
 
+  bool seek(const size_t _row) final { return m_read_data.seek(_row); }
+
+  void read_all(const size_t _nthreads) final {
+    m_read_data.read_all_parallel(
+        _nthreads, [&](const RowBatch &_rows) { push_rows(_rows); });
+    end_of_data();
+  }
+
+  bool read_batch() final {
+    const auto r = m_read_data.read_batch(
+        [&](const RowBatch &_rows) { push_rows(_rows); });
+    if (!r)
+      end_of_data();
+    return r;
+  }
+
+  const PageIndex &page_index() final {
+    if (m_read_data.index.empty())
+      m_read_data.index = m_read_data.build_index();
+    return m_read_data.index;
+  }
+
+  void set_page_index(PageIndex &&_index) final {
+    m_read_data.index = std::move(_index);
+  }
+
+  Reader::PIMPL partition(Reader::PSOURCE &&_source, Reader::PSINK &&_sink,
+                          const PageIndex::Partition &_partition) final {
+    // Build the index once, it is shared with the partition.
+    page_index();
+    auto pimpl = std::make_unique<ReaderImpl>(
+        _RD(m_read_data, std::move(_source), _partition), std::move(_sink),
+        PPROPERTIES(shared_properties()));
+    pimpl->set_row_filter(row_filter());
+    return pimpl;
+  }
+
   Column::PBUF read_row_no_sink() final {
     auto vals = m_read_data.read_line();
     return vals ? vals->data() : nullptr;
   }
 
+  bool read_sample(const std::vector<size_t> &_rows) final {
+    bool r = true;
+    for (const auto row : _rows) {
+      if (!m_read_data.move_to(row)) {
+        r = false;
+        break;
+      }
+      auto vals = m_read_data.read_line();
+      if (!vals) {
+        r = false;
+        break;
+      }
+      push_row(row, vals->data());
+    }
+    end_of_data();
+    return r;
+  }
+
   bool read_row() final {
     const size_t row_index = current_row_index();
     auto vals = m_read_data.read_line();
@@ -18,11 +18,14 @@ Reader::~Reader() = default;
 Reader::DataSourceConcept::~DataSourceConcept() = default;
 Reader::DatasetSinkConcept::~DatasetSinkConcept() = default;
 Reader::FilterConcept::~FilterConcept() = default;
+Reader::RowFilterConcept::~RowFilterConcept() = default;
 
 Reader::Reader(PSOURCE &&_source, PSINK &&_sink, PFILTER &&_filter)
     : m_pimpl(impl::build(std::move(_source), std::move(_sink),
                           std::move(_filter))) {}
 
+Reader::Reader(PIMPL &&_pimpl) noexcept : m_pimpl(std::move(_pimpl)) {}
+
 Reader::PIMPL Reader::impl::build(PSOURCE &&_source, PSINK &&_sink,
                                   PFILTER &&_filter) {
   Properties properties;
@@ -32,8 +35,9 @@ Reader::PIMPL Reader::impl::build(PSOURCE &&_source, PSINK &&_sink,
       [&](auto &&arg) -> Reader::PIMPL {
         using T = std::decay_t<decltype(arg)>;
         using RI = INTERNAL::ReaderImpl<T>;
-        return std::make_unique<RI>(std::move(arg), std::move(_sink),
-                                    std::move(properties));
+        return std::make_unique<RI>(
+            std::move(arg), std::move(_sink),
+            std::make_shared<const Properties>(std::move(properties)));
       },
       std::move(rd));
 }
@@ -52,17 +56,61 @@ bool Reader::skip(const size_t _nrows) {
   return m_pimpl ? m_pimpl->skip(_nrows) : false;
 }
 
+bool Reader::seek(const size_t _row) {
+  return m_pimpl ? m_pimpl->seek(_row) : false;
+}
+
+const PageIndex &Reader::page_index() {
+  static const PageIndex empty;
+  return m_pimpl ? m_pimpl->page_index() : empty;
+}
+
+void Reader::set_page_index(PageIndex _index) {
+  if (m_pimpl)
+    m_pimpl->set_page_index(std::move(_index));
+}
+
+void Reader::set_row_filter(PROWFILTER &&_filter) {
+  if (m_pimpl)
+    m_pimpl->set_row_filter(std::move(_filter));
+}
+
+std::vector<PageIndex::Partition> Reader::partitions(const size_t _count) {
+  return page_index().partitions(_count);
+}
+
+Reader Reader::partition(const PageIndex::Partition &_partition,
+                         PSOURCE &&_source, PSINK &&_sink) {
+  if (!m_pimpl)
+    return Reader();
+  return Reader(
+      m_pimpl->partition(std::move(_source), std::move(_sink), _partition));
+}
+
 void Reader::read_all() {
   if (m_pimpl)
     m_pimpl->read_all();
 }
 
+void Reader::read_all(const size_t _nthreads) {
+  if (!m_pimpl)
+    return;
+  if (_nthreads > 1)
+    m_pimpl->read_all(_nthreads);
+  else
+    m_pimpl->read_all();
+}
+
 bool Reader::read_row() { return m_pimpl ? m_pimpl->read_row() : false; }
 
 bool Reader::read_rows(const size_t _chunk_size) {
   return m_pimpl ? m_pimpl->read_rows(_chunk_size) : false;
 }
 
+bool Reader::read_sample(const std::vector<size_t> &_rows) {
+  return m_pimpl ? m_pimpl->read_sample(_rows) : false;
+}
+
 size_t Reader::current_row_index() const noexcept {
   return m_pimpl ? m_pimpl->current_row_index() : 0;
 }
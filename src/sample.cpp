@@ -0,0 +1,66 @@
+/**
+ *  \file src/sample.cpp
+ *
+ *  \brief Row sampling
+ *
+ *  \author Olivia Quinet
+ */
+
+#include <algorithm>
+#include <cppsas7bdat/sample.hpp>
+#include <numeric>
+#include <random>
+#include <unordered_set>
+
+namespace cppsas7bdat {
+
+namespace {
+/// Uniform integer in [0, _n), without the bias of the modulo.
+/// std::uniform_int_distribution is not the same on all the platforms.
+size_t draw(std::mt19937_64 &_gen, const size_t _n) {
+  const uint64_t n = _n;
+  const uint64_t threshold = (0 - n) % n;
+  uint64_t x;
+  do {
+    x = _gen();
+  } while (x < threshold);
+  return x % n;
+}
+} // namespace
+
+std::vector<size_t> Sample::systematic(const size_t _row_count,
+                                       const size_t _step,
+                                       const size_t _first) {
+  std::vector<size_t> rows;
+  if (_step == 0 || _first >= _row_count)
+    return rows;
+  rows.reserve((_row_count - _first - 1) / _step + 1);
+  for (size_t row = _first; row < _row_count; row += _step)
+    rows.push_back(row);
+  return rows;
+}
+
+std::vector<size_t> Sample::random(const size_t _row_count,
+                                   const size_t _count, const uint64_t _seed) {
+  std::vector<size_t> rows;
+  if (_count >= _row_count) {
+    rows.resize(_row_count);
+    std::iota(rows.begin(), rows.end(), size_t{0});
+    return rows;
+  }
+  // Floyd's algorithm: _count draws whatever the number of rows.
+  std::mt19937_64 gen(_seed);
+  std::unordered_set<size_t> chosen;
+  chosen.reserve(_count);
+  rows.reserve(_count);
+  for (size_t j = _row_count - _count; j < _row_count; ++j) {
+    const size_t row = draw(gen, j + 1);
+    const auto selected = chosen.insert(row).second ? row : j;
+    chosen.insert(selected);
+    rows.push_back(selected);
+  }
+  std::sort(rows.begin(), rows.end());
+  return rows;
+}
+
+} // namespace cppsas7bdat
@@ -54,6 +54,7 @@ _read_header(CHECK_HEADER<DATASOURCE> &&ch, Properties::Header *_header) {
   READ_HEADER<DATASOURCE, _endian, _format> rh(std::move(ch));
   rh.set_header_length_and_read(_header);
   rh.set_header(_header);
+  rh.is->set_header(*_header);
   return rh;
 }
 
@@ -68,12 +69,13 @@ _read_metadata(READ_HEADER<DATASOURCE, _endian, _format> &&rh,
   return rm;
 }
 
-template <Endian _endian, Format _format, typename _Decompressor>
-inline READ_DATA<DATASOURCE, _endian, _format, _Decompressor>
+template <Endian _endian, Format _format, ASSERT _assert,
+          typename _Decompressor>
+inline READ_DATA<DATASOURCE, _endian, _format, _Decompressor, _assert>
 _read_data(READ_METADATA<DATASOURCE, _endian, _format> &&rm,
            _Decompressor &&_decompressor,
            const Properties::Metadata *_metadata) {
-  READ_DATA<DATASOURCE, _endian, _format, _Decompressor> rd(
+  READ_DATA<DATASOURCE, _endian, _format, _Decompressor, _assert> rd(
       std::move(rm), std::forward<_Decompressor>(_decompressor), _metadata);
   return rd;
 }
@@ -87,27 +89,45 @@ using RM =
                  READ_METADATA<DATASOURCE, Endian::big, Format::bit32>,
                  READ_METADATA<DATASOURCE, Endian::little, Format::bit64>,
                  READ_METADATA<DATASOURCE, Endian::little, Format::bit32>>;
+
+template <Endian _endian, Format _format, ASSERT _assert>
+using READ_DATA_NONE =
+    READ_DATA<DATASOURCE, _endian, _format, DECOMPRESSOR::None, _assert>;
+template <Endian _endian, Format _format, ASSERT _assert>
+using READ_DATA_RDC =
+    READ_DATA<DATASOURCE, _endian, _format,
+              DECOMPRESSOR::RDC<_endian, _format, _assert>, _assert>;
+template <Endian _endian, Format _format, ASSERT _assert>
+using READ_DATA_RLE =
+    READ_DATA<DATASOURCE, _endian, _format,
+              DECOMPRESSOR::RLE<_endian, _format, _assert>, _assert>;
+
+// The ASSERT::NO alternatives are used for the trusted data sources.
 using RD = std::variant<
-    READ_DATA<DATASOURCE, Endian::big, Format::bit64, DECOMPRESSOR::None>,
-    READ_DATA<DATASOURCE, Endian::big, Format::bit64,
-              DECOMPRESSOR::RDC<Endian::big, Format::bit64>>,
-    READ_DATA<DATASOURCE, Endian::big, Format::bit64,
-              DECOMPRESSOR::RLE<Endian::big, Format::bit64>>,
-    READ_DATA<DATASOURCE, Endian::big, Format::bit32, DECOMPRESSOR::None>,
-    READ_DATA<DATASOURCE, Endian::big, Format::bit32,
-              DECOMPRESSOR::RDC<Endian::big, Format::bit32>>,
-    READ_DATA<DATASOURCE, Endian::big, Format::bit32,
-              DECOMPRESSOR::RLE<Endian::big, Format::bit32>>,
-    READ_DATA<DATASOURCE, Endian::little, Format::bit64, DECOMPRESSOR::None>,
-    READ_DATA<DATASOURCE, Endian::little, Format::bit64,
-              DECOMPRESSOR::RDC<Endian::little, Format::bit64>>,
-    READ_DATA<DATASOURCE, Endian::little, Format::bit64,
-              DECOMPRESSOR::RLE<Endian::little, Format::bit64>>,
-    READ_DATA<DATASOURCE, Endian::little, Format::bit32, DECOMPRESSOR::None>,
-    READ_DATA<DATASOURCE, Endian::little, Format::bit32,
-              DECOMPRESSOR::RDC<Endian::little, Format::bit32>>,
-    READ_DATA<DATASOURCE, Endian::little, Format::bit32,
-              DECOMPRESSOR::RLE<Endian::little, Format::bit32>>>;
+    READ_DATA_NONE<Endian::big, Format::bit64, ASSERT::YES>,
+    READ_DATA_RDC<Endian::big, Format::bit64, ASSERT::YES>,
+    READ_DATA_RLE<Endian::big, Format::bit64, ASSERT::YES>,
+    READ_DATA_NONE<Endian::big, Format::bit32, ASSERT::YES>,
+    READ_DATA_RDC<Endian::big, Format::bit32, ASSERT::YES>,
+    READ_DATA_RLE<Endian::big, Format::bit32, ASSERT::YES>,
+    READ_DATA_NONE<Endian::little, Format::bit64, ASSERT::YES>,
+    READ_DATA_RDC<Endian::little, Format::bit64, ASSERT::YES>,
+    READ_DATA_RLE<Endian::little, Format::bit64, ASSERT::YES>,
+    READ_DATA_NONE<Endian::little, Format::bit32, ASSERT::YES>,
+    READ_DATA_RDC<Endian::little, Format::bit32, ASSERT::YES>,
+    READ_DATA_RLE<Endian::little, Format::bit32, ASSERT::YES>,
+    READ_DATA_NONE<Endian::big, Format::bit64, ASSERT::NO>,
+    READ_DATA_RDC<Endian::big, Format::bit64, ASSERT::NO>,
+    READ_DATA_RLE<Endian::big, Format::bit64, ASSERT::NO>,
+    READ_DATA_NONE<Endian::big, Format::bit32, ASSERT::NO>,
+    READ_DATA_RDC<Endian::big, Format::bit32, ASSERT::NO>,
+    READ_DATA_RLE<Endian::big, Format::bit32, ASSERT::NO>,
+    READ_DATA_NONE<Endian::little, Format::bit64, ASSERT::NO>,
+    READ_DATA_RDC<Endian::little, Format::bit64, ASSERT::NO>,
+    READ_DATA_RLE<Endian::little, Format::bit64, ASSERT::NO>,
+    READ_DATA_NONE<Endian::little, Format::bit32, ASSERT::NO>,
+    READ_DATA_RDC<Endian::little, Format::bit32, ASSERT::NO>,
+    READ_DATA_RLE<Endian::little, Format::bit32, ASSERT::NO>>;
 
 inline RH read_header(CHECK_HEADER<DATASOURCE> &&ch,
                       Properties::Header *_header) {
@@ -138,27 +158,38 @@ inline RM read_metadata(RH &&rh, const Properties::Header *_header,
       std::move(rh));
 }
 
-inline RD read_data(RM &&rm, const Properties::Metadata *_metadata) {
+template <ASSERT _assert>
+inline RD _read_data(RM &&rm, const Properties::Metadata *_metadata) {
   return std::visit(
       [&](auto &&arg) -> RD {
         using T = std::decay_t<decltype(arg)>;
         switch (_metadata->compression) {
         case Compression::RDC:
-          return _read_data<T::endian, T::format>(
+          return _read_data<T::endian, T::format, _assert>(
               std::forward<T>(arg),
-              DECOMPRESSOR::RDC<T::endian, T::format>(_metadata), _metadata);
+              DECOMPRESSOR::RDC<T::endian, T::format, _assert>(_metadata),
+              _metadata);
         case Compression::RLE:
-          return _read_data<T::endian, T::format>(
+          return _read_data<T::endian, T::format, _assert>(
               std::forward<T>(arg),
-              DECOMPRESSOR::RLE<T::endian, T::format>(_metadata), _metadata);
+              DECOMPRESSOR::RLE<T::endian, T::format, _assert>(_metadata),
+              _metadata);
         default:
-          return _read_data<T::endian, T::format>(
+          return _read_data<T::endian, T::format, _assert>(
               std::forward<T>(arg), DECOMPRESSOR::None(), _metadata);
         }
       },
       std::move(rm));
 }
 
+inline RD read_data(RM &&rm, const Properties::Metadata *_metadata,
+                    const bool _trusted) {
+  if (_trusted)
+    return _read_data<ASSERT::NO>(std::move(rm), _metadata);
+  else
+    return _read_data<ASSERT::YES>(std::move(rm), _metadata);
+}
+
 inline auto read_line(RD &rd) {
   return std::visit([&](auto &&arg) { return arg.read_line(); }, rd);
 }
@@ -189,9 +220,10 @@ inline INTERNAL::RD data(INTERNAL::DATASOURCE &&_source,
                          Properties::Header *_header,
                          Properties::Metadata *_metadata,
                          const Reader::PFILTER &_filter) {
+  const bool trusted = _source->is_trusted();
   return INTERNAL::read_data(
       READ::metadata(std::move(_source), _header, _metadata, _filter),
-      _metadata);
+      _metadata, trusted);
 }
 
 } // namespace READ
@@ -0,0 +1,92 @@
+/**
+ *  \file src/thread_pool.hpp
+ *
+ *  \brief Thread pool
+ *
+ *  \author Olivia Quinet
+ */
+
+#ifndef _CPP_SAS7BDAT_SRC_THREAD_POOL_HPP_
+#define _CPP_SAS7BDAT_SRC_THREAD_POOL_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cppsas7bdat {
+namespace INTERNAL {
+
+/**
+ *  Fixed number of worker threads executing the submitted tasks in the
+ *  order of submission.  The destructor waits for the queued tasks.
+ */
+class THREAD_POOL {
+public:
+  explicit THREAD_POOL(const size_t _nthreads) {
+    workers.reserve(_nthreads);
+    for (size_t i = 0; i < _nthreads; ++i)
+      workers.emplace_back([this]() { run(); });
+  }
+
+  THREAD_POOL(const THREAD_POOL &) = delete;
+  THREAD_POOL &operator=(const THREAD_POOL &) = delete;
+
+  ~THREAD_POOL() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    cv.notify_all();
+    for (auto &worker : workers)
+      worker.join();
+  }
+
+  /// Queue _fct and return the future of its result.
+  template <typename _Fct> auto submit(_Fct &&_fct) {
+    using R = std::invoke_result_t<_Fct>;
+    auto task =
+        std::make_shared<std::packaged_task<R()>>(std::forward<_Fct>(_fct));
+    auto result = task->get_future();
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      tasks.emplace_back([task]() { (*task)(); });
+    }
+    cv.notify_one();
+    return result;
+  }
+
+  size_t size() const noexcept { return workers.size(); }
+
+private:
+  void run() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+        if (tasks.empty())
+          return;
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<std::function<void()>> tasks;
+  bool stopping{false};
+  std::vector<std::thread> workers;
+};
+
+} // namespace INTERNAL
+} // namespace cppsas7bdat
+
+#endif
@@ -9,13 +9,20 @@
 #ifndef _CPP_SAS7BDAT_SRC_TYPES_HPP_
 #define _CPP_SAS7BDAT_SRC_TYPES_HPP_
 
+#include <bit>
 #include <boost/endian/conversion.hpp>
-#include <cctype>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <type_traits>
 //#include <endian.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace cppsas7bdat {
 namespace INTERNAL {
 
@@ -24,10 +31,71 @@ inline std::string_view get_string(const uint8_t *_buf,
   return std::string_view(reinterpret_cast<const char *>(_buf), _length);
 }
 
+/// std::isspace in the C locale, whatever the current locale.
+constexpr bool is_space(const uint8_t _c) noexcept {
+  return _c == ' ' || (_c >= '\t' && _c <= '\r');
+}
+
+/// std::isprint in the C locale, whatever the current locale.
+constexpr bool is_print(const uint8_t _c) noexcept {
+  return _c >= ' ' && _c <= '~';
+}
+
+#if defined(__SSE2__)
+/// Bit i set if the byte i of _x is neither NUL nor a space.
+inline unsigned not_blank_mask(const __m128i _x) noexcept {
+  const __m128i t = _mm_sub_epi8(_x, _mm_set1_epi8('\t'));
+  const __m128i blank = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(_x, _mm_setzero_si128()),
+                   _mm_cmpeq_epi8(_x, _mm_set1_epi8(' '))),
+      _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8('\r' - '\t')), t));
+  return ~static_cast<unsigned>(_mm_movemask_epi8(blank)) & 0xFFFF;
+}
+#endif
+
+#if defined(__AVX2__)
+inline unsigned not_blank_mask(const __m256i _x) noexcept {
+  const __m256i t = _mm256_sub_epi8(_x, _mm256_set1_epi8('\t'));
+  const __m256i blank = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(_x, _mm256_setzero_si256()),
+                      _mm256_cmpeq_epi8(_x, _mm256_set1_epi8(' '))),
+      _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8('\r' - '\t')),
+                        t));
+  return ~static_cast<unsigned>(_mm256_movemask_epi8(blank));
+}
+#endif
+
+/**
+ *  Remove the trailing NUL and space characters.
+ *
+ *  The string columns are mostly padding: with SSE2, the end of the value
+ *  is scanned 16 (AVX2: 32) bytes at a time.
+ */
 inline std::string_view get_string_trim_0(const uint8_t *_buf,
                                           size_t _length) noexcept {
-  while (_length &&
-         (_buf[_length - 1] == 0 || std::isspace(_buf[_length - 1]))) {
+#if defined(__AVX2__)
+  while (_length >= 32) {
+    const auto x = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(_buf + _length - 32));
+    const auto mask = not_blank_mask(x);
+    if (mask)
+      return get_string(_buf, _length - 32 +
+                                  static_cast<size_t>(std::bit_width(mask)));
+    _length -= 32;
+  }
+#endif
+#if defined(__SSE2__)
+  while (_length >= 16) {
+    const auto x =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(_buf + _length - 16));
+    const auto mask = not_blank_mask(x);
+    if (mask)
+      return get_string(_buf, _length - 16 +
+                                  static_cast<size_t>(std::bit_width(mask)));
+    _length -= 16;
+  }
+#endif
+  while (_length && (_buf[_length - 1] == 0 || is_space(_buf[_length - 1]))) {
     --_length;
   }
   return get_string(_buf, _length);
@@ -36,12 +104,12 @@ inline std::string_view get_string_trim_0(const uint8_t *_buf,
 inline std::string_view get_string_trim(const uint8_t *_buf,
                                         size_t _length) noexcept {
   size_t offset = 0;
-  while (_length && std::isspace(_buf[offset])) {
+  while (_length && is_space(_buf[offset])) {
     ++offset;
     --_length;
   }
-  while (_length && (!std::isprint(_buf[offset + _length - 1]) ||
-                     std::isspace(_buf[offset + _length - 1]))) {
+  while (_length && (!is_print(_buf[offset + _length - 1]) ||
+                     is_space(_buf[offset + _length - 1]))) {
     --_length;
   }
   return get_string(_buf + offset, _length);
@@ -160,14 +228,35 @@ inline TIME get_time_from_epoch(const double _seconds) noexcept {
   return get_datetime_from_epoch(_seconds).time_of_day();
 }
 
+/// Days between the SAS epoch (1960-01-01) and the first and last dates of
+/// boost::gregorian (1400-01-01 and 9999-12-31).
+constexpr double MIN_DATE_DAYS{-204535};
+constexpr double MAX_DATE_DAYS{2936549};
+
+/// A SAS date (in days) within the boost::gregorian dates.
+inline bool is_date_days(const double _days) noexcept {
+  const auto days = std::round(_days);
+  return MIN_DATE_DAYS <= days && days <= MAX_DATE_DAYS;
+}
+
+/// A SAS datetime (in seconds) within the boost::gregorian dates, with a
+/// second of margin for the rounding of the microseconds.
+inline bool is_date_seconds(const double _seconds) noexcept {
+  constexpr double seconds_in_a_day{24 * 60 * 60};
+  return MIN_DATE_DAYS * seconds_in_a_day <= _seconds &&
+         _seconds < (MAX_DATE_DAYS + 1) * seconds_in_a_day - 1;
+}
+
 inline DATE get_date_from_epoch_seconds(const double _seconds) noexcept {
+  if (!is_date_seconds(_seconds))
+    return DATE(boost::gregorian::not_a_date_time);
   return get_datetime_from_epoch(_seconds).date();
 }
 
 inline DATE get_date_from_epoch_days(const double _days) noexcept {
   using namespace boost::posix_time;
   using namespace boost::gregorian;
-  if (std::isnan(_days))
+  if (!is_date_days(_days))
     return DATE(not_a_date_time);
   ptime start(boost::gregorian::date(1960, 1, 1));
   return (start + days(std::lround(_days))).date();
@@ -181,6 +270,65 @@ inline DATE get_date_from_epoch(const double _t) noexcept {
     return x;
 }
 
+/// Days between the SAS epoch (1960-01-01) and the Unix epoch.
+constexpr EPOCH SAS_TO_UNIX_DAYS{3653};
+constexpr EPOCH MICROSECONDS_IN_A_DAY{86400LL * 1000000LL};
+
+/// Largest SAS datetime (in seconds) whose microseconds since 1970-01-01
+/// fit in an EPOCH, with a day of margin for the rounding of the days.
+constexpr double MAX_EPOCH_SECONDS{
+    static_cast<double>(std::numeric_limits<EPOCH>::max() / 1000000 -
+                        (SAS_TO_UNIX_DAYS + 1) * 86400)};
+
+/// Same rounding as get_datetime_from_epoch: _days, _microseconds of the
+/// day (possibly negative) or false if the value is missing or out of
+/// range, see MAX_EPOCH_SECONDS.
+inline bool split_epoch_seconds(double _seconds, EPOCH &_days,
+                                EPOCH &_microseconds) noexcept {
+  if (!(std::fabs(_seconds) < MAX_EPOCH_SECONDS))
+    return false;
+  constexpr double seconds_in_a_day{24 * 60 * 60};
+  const auto days = std::round(_seconds / seconds_in_a_day);
+  _seconds -= days * seconds_in_a_day;
+  const auto secs = std::round(_seconds);
+  const auto microseconds = std::round((_seconds - secs) * 1e6);
+  _days = static_cast<EPOCH>(days);
+  _microseconds =
+      static_cast<EPOCH>(secs) * 1000000 + static_cast<EPOCH>(microseconds);
+  return true;
+}
+
+/// Microseconds since 1970-01-01 of a SAS datetime.
+inline EPOCH get_unix_microseconds(const double _seconds) noexcept {
+  EPOCH days, microseconds;
+  if (!split_epoch_seconds(_seconds, days, microseconds))
+    return EPOCH_NA;
+  return (days - SAS_TO_UNIX_DAYS) * MICROSECONDS_IN_A_DAY + microseconds;
+}
+
+/// Microseconds since midnight of a SAS time, see get_time_from_epoch.
+inline EPOCH get_day_microseconds(const double _seconds) noexcept {
+  EPOCH days, microseconds;
+  if (!split_epoch_seconds(_seconds, days, microseconds))
+    return EPOCH_NA;
+  return (microseconds % MICROSECONDS_IN_A_DAY + MICROSECONDS_IN_A_DAY) %
+         MICROSECONDS_IN_A_DAY;
+}
+
+/// Days since 1970-01-01 of a SAS date, with the same rule as
+/// get_date_from_epoch: a value outside of the dates is read as seconds.
+inline EPOCH get_unix_days(const double _days) noexcept {
+  if (is_date_days(_days))
+    return static_cast<EPOCH>(std::round(_days)) - SAS_TO_UNIX_DAYS;
+  EPOCH days, microseconds;
+  if (!is_date_seconds(_days) ||
+      !split_epoch_seconds(_days, days, microseconds))
+    return EPOCH_NA;
+  // The microseconds of the day are negative before noon, see
+  // get_datetime_from_epoch.
+  return days - (microseconds < 0 ? 1 : 0) - SAS_TO_UNIX_DAYS;
+}
+
 template <Format _format> struct number_types {};
 
 template <> struct number_types<Format::bit64> {
@@ -6,6 +6,7 @@
  *  \author  Olivia Quinet
  */
 
+#include "../include/cppsas7bdat/decode_plan.hpp"
 #include "../src/sas7bdat-impl.hpp"
 #include <catch2/catch_test_macros.hpp>
 
@@ -62,6 +63,34 @@ SCENARIO("The Column accepts a formatter and uses correctly") {
   }
 }
 
+SCENARIO("The Column extracts the values of a batch of rows at once") {
+  GIVEN("A column with a formatter without bulk methods") {
+    const auto test = Column("name", "label", "format", TestFormatter{});
+    THEN("The values are extracted one by one") {
+      const Column::PBUF rows[2] = {nullptr, nullptr};
+      SV strings[2];
+      NUMBER numbers[2];
+      INTEGER integers[2];
+      test.get_strings(rows, 2, strings);
+      test.get_numbers(rows, 2, numbers);
+      test.get_integers(RowBatch{0, 2, rows}, integers);
+      CHECK(strings[1] == "hello, world!");
+      CHECK(numbers[1] == 3.1415);
+      CHECK(integers[0] == 42);
+      CHECK(integers[1] == 42);
+    }
+    THEN("All the values are valid") {
+      const Column::PBUF rows[10] = {};
+      uint8_t validity[2] = {0, 0xFF};
+      char codes[10];
+      test.get_validity(rows, 10, validity, codes);
+      CHECK(validity[0] == 0xFF);
+      CHECK(validity[1] == 0x03);
+      CHECK(std::count(codes, codes + 10, '\0') == 10);
+    }
+  }
+}
+
 SCENARIO("A vector of columns is splitted in different column types") {
   GIVEN("A list of columns") {
     COLUMNS columns{
@@ -91,3 +120,69 @@ SCENARIO("A vector of columns is splitted in different column types") {
     }
   }
 }
+
+SCENARIO("The decode plan gives the same values as the columns") {
+  using namespace cppsas7bdat::INTERNAL::FORMATTER;
+  GIVEN("Columns of all the formatters and a row") {
+    COLUMNS columns{
+        Column("s1", "", "", StringFormatter(0, 4)),
+        Column("n1", "", "", DoubleFormatter<Endian::little>(4, 8)),
+        Column("n2", "", "", IncompleteDoubleFormatter<Endian::little, 4>(12, 4)),
+        Column("i1", "", "", SmallIntegerFormatter(16, 1)),
+        Column("i2", "", "", IntegerFormatter<Endian::little, int16_t>(17, 2)),
+        Column("dt", "", "", DateTimeFormatter<Endian::little>(19, 8)),
+        Column("d", "", "", DateFormatter<Endian::little>(27, 8)),
+        Column("t", "", "", TimeFormatter<Endian::little>(35, 8)),
+        Column("n3", "", "", DoubleFormatter<Endian::big>(43, 8)),
+        Column("s2", "", "", StringFormatter(51, 3)),
+        Column("n4", "", "", TestFormatter(Column::Type::number)),
+        Column("u", "", "", NoFormatter(0, 1)),
+    };
+    uint8_t row[54] = {'a', 'b', ' ', 0};
+    const double x = 1234.5, dt = 5e8, d = 12345.0, t = 3723.0, y = -2.25;
+    std::memcpy(row + 4, &x, 8);
+    std::memcpy(row + 12, reinterpret_cast<const uint8_t *>(&y) + 4, 4);
+    row[16] = 200;
+    const int16_t i = -300;
+    std::memcpy(row + 17, &i, 2);
+    std::memcpy(row + 19, &dt, 8);
+    std::memcpy(row + 27, &d, 8);
+    std::memcpy(row + 35, &t, 8);
+    for (size_t k = 0; k < 8; ++k)
+      row[43 + k] = reinterpret_cast<const uint8_t *>(&x)[7 - k];
+    std::memcpy(row + 51, "xyz", 3);
+    WHEN("The row is decoded") {
+      const DecodePlan plan(columns);
+      auto values = plan.make_values();
+      plan.decode(row, values);
+      THEN("The operations are grouped") {
+        // One group for the strings, the numbers are grouped by length and
+        // endianness and the test formatter has its own group.
+        CHECK(plan.steps().size() == 11);
+        CHECK(plan.groups().size() == 10);
+      }
+      THEN("The values are the ones of the getters") {
+        const auto &c = plan.columns();
+        REQUIRE(values.strings.size() == 2);
+        REQUIRE(values.numbers.size() == 4);
+        REQUIRE(values.integers.size() == 2);
+        for (size_t k = 0; k < c.strings.size(); ++k)
+          CHECK(values.strings[k] == c.strings[k].get_string(row));
+        for (size_t k = 0; k < c.numbers.size(); ++k)
+          CHECK(values.numbers[k] == c.numbers[k].get_number(row));
+        for (size_t k = 0; k < c.integers.size(); ++k)
+          CHECK(values.integers[k] == c.integers[k].get_integer(row));
+        CHECK(values.datetimes[0] == c.datetimes[0].get_datetime(row));
+        CHECK(values.dates[0] == c.dates[0].get_date(row));
+        CHECK(values.times[0] == c.times[0].get_time(row));
+        CHECK(values.strings[0] == "ab");
+        CHECK(values.numbers[0] == 1234.5);
+        CHECK(values.numbers[1] == -2.25);
+        CHECK(values.numbers[2] == 1234.5);
+        CHECK(values.numbers[3] == 3.1415);
+        CHECK(values.integers[0] == 200);
+        CHECK(values.integers[1] == -300);
+      }
+    }
+  }
+}
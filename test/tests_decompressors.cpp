@@ -6,7 +6,11 @@
  *  \author  Olivia Quinet
  */
 
+#include "../include/cppsas7bdat/source/ifstream.hpp"
 #include "../src/sas7bdat-impl.hpp"
+#include "data.hpp"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators_all.hpp>
 #include <catch2/matchers/catch_matchers_all.hpp>
@@ -22,6 +26,326 @@ const BYTES operator"" _b(const char *_p, size_t _n) {
 }
 const auto source1{"a"_b};
 const auto source2{"abcdefghijklmnopqrstuvwxyz"_b};
+
+/// The original SASYZCR2 decoder, one control bit at a time, used as the
+/// reference for the RDC decompressor.  The patterns are copied byte by
+/// byte, i.e. an overlapping pattern is repeated.
+template <Endian _endian, Format _format>
+struct RDC_REFERENCE : public DST_VALUES<_endian, _format> {
+  using DST_VALUES<_endian, _format>::buf;
+  using DST_VALUES<_endian, _format>::reset;
+  using DST_VALUES<_endian, _format>::fill;
+  using DST_VALUES<_endian, _format>::check;
+  using DST_VALUES<_endian, _format>::assert_check;
+  using DST_VALUES<_endian, _format>::store_value;
+  using DST_VALUES<_endian, _format>::i_dst;
+
+  explicit RDC_REFERENCE(const Properties::Metadata *_metadata)
+      : DST_VALUES<_endian, _format>(_metadata) {}
+
+  void store_pattern(const size_t _offset, const size_t _n) {
+    assert_check(_n);
+    if (_offset > i_dst)
+      EXCEPTION::cannot_decompress();
+    for (size_t i = 0; i < _n; ++i, ++i_dst)
+      buf.set(i_dst, buf[i_dst - _offset]);
+  }
+
+  BYTES operator()(const BYTES &_values) {
+    reset();
+    SRC_VALUES src(_values);
+    int32_t ctrl_mask{0};
+    int32_t ctrl_bits{0};
+
+    while (src.check(3) && check()) {
+      ctrl_mask >>= 1;
+      if (ctrl_mask == 0) {
+        ctrl_bits = (static_cast<int32_t>(src.pop())) << 8;
+        ctrl_bits += (static_cast<int32_t>(src.pop()));
+        ctrl_mask = 0x8000;
+      }
+      if ((ctrl_bits & ctrl_mask) == 0) {
+        store_value(src.pop(), 1);
+      } else {
+        const auto val = src.pop();
+        const uint8_t cmd = (val >> 4) & 0x0F;
+        size_t cnt = val & 0x0F;
+        if (cmd == 0) {
+          cnt += 3;
+          store_value(src.pop(), cnt);
+        } else if (cmd == 1) {
+          cnt += static_cast<size_t>((static_cast<int32_t>(src.pop()) << 4) +
+                                     19);
+          store_value(src.pop(), cnt);
+        } else if (cmd == 2) {
+          const size_t ofs =
+              cnt + 3 + static_cast<size_t>(static_cast<int32_t>(src.pop()) << 4);
+          cnt = static_cast<size_t>(src.pop() + 16);
+          store_pattern(ofs, cnt);
+        } else {
+          const size_t ofs =
+              cnt + 3 + static_cast<size_t>(static_cast<int32_t>(src.pop()) << 4);
+          store_pattern(ofs, cmd);
+        }
+      }
+    }
+    fill();
+    return buf.as_bytes();
+  }
+};
+
+/// The original SASYZCRL decoder, one command at a time, used as the
+/// reference for the RLE decompressor.
+template <Endian _endian, Format _format>
+struct RLE_REFERENCE : public DST_VALUES<_endian, _format> {
+  using DST_VALUES<_endian, _format>::buf;
+  using DST_VALUES<_endian, _format>::reset;
+  using DST_VALUES<_endian, _format>::fill;
+  using DST_VALUES<_endian, _format>::check;
+  using DST_VALUES<_endian, _format>::assert_check;
+  using DST_VALUES<_endian, _format>::store_value;
+  using DST_VALUES<_endian, _format>::i_dst;
+
+  explicit RLE_REFERENCE(const Properties::Metadata *_metadata)
+      : DST_VALUES<_endian, _format>(_metadata) {}
+
+  BYTES operator()(const BYTES &_values) {
+    constexpr uint8_t FOUR{4}, EIGHT{8};
+
+    reset();
+    SRC_VALUES src(_values);
+    auto store_values = [&](size_t n) {
+      n = std::min(n, src.remaining());
+      assert_check(n);
+      buf.copy(i_dst, src.pop(n));
+      i_dst += n;
+    };
+
+    while (src.check(2) && check()) {
+      const auto val = src.pop();
+      const uint8_t command = static_cast<uint8_t>(val >> FOUR);
+      const size_t end_of_first_byte = static_cast<size_t>(val & 0x0F);
+      switch (command) {
+      case SAS_RLE_COMMAND_COPY64: {
+        const size_t n = (end_of_first_byte << EIGHT) + src.pop() + 64;
+        store_values(n);
+      } break;
+      case SAS_RLE_COMMAND_INSERT_BYTE18: {
+        const size_t n = (end_of_first_byte << FOUR) + src.pop() + 18;
+        store_value(src.pop(), n);
+      } break;
+      case SAS_RLE_COMMAND_INSERT_AT17: {
+        const size_t n = (end_of_first_byte << EIGHT) + src.pop() + 17;
+        store_value(C_AT, n);
+      } break;
+      case SAS_RLE_COMMAND_INSERT_BLANK17: {
+        const size_t n = (end_of_first_byte << EIGHT) + src.pop() + 17;
+        store_value(C_SPACE, n);
+      } break;
+      case SAS_RLE_COMMAND_INSERT_ZERO17: {
+        const size_t n = (end_of_first_byte << EIGHT) + src.pop() + 17;
+        store_value(C_NULL, n);
+      } break;
+      case SAS_RLE_COMMAND_COPY1: {
+        store_values(end_of_first_byte + 1);
+      } break;
+      case SAS_RLE_COMMAND_COPY17: {
+        store_values(end_of_first_byte + 17);
+      } break;
+      case SAS_RLE_COMMAND_COPY33: {
+        store_values(end_of_first_byte + 33);
+      } break;
+      case SAS_RLE_COMMAND_COPY49: {
+        store_values(end_of_first_byte + 49);
+      } break;
+      case SAS_RLE_COMMAND_INSERT_BYTE3: {
+        store_value(src.pop(), end_of_first_byte + 3);
+      } break;
+      case SAS_RLE_COMMAND_INSERT_AT2: {
+        store_value(C_AT, end_of_first_byte + 2);
+      } break;
+      case SAS_RLE_COMMAND_INSERT_BLANK2: {
+        store_value(C_SPACE, end_of_first_byte + 2);
+      } break;
+      case SAS_RLE_COMMAND_INSERT_ZERO2: {
+        store_value(C_NULL, end_of_first_byte + 2);
+      } break;
+      default:
+        EXCEPTION::cannot_decompress();
+      }
+    }
+    fill();
+    return buf.as_bytes();
+  }
+};
+
+using ROW = std::vector<uint8_t>;
+
+/// Decompress _row with _decompressor, or return an empty row if it throws.
+template <typename _Decompressor>
+ROW decompress(_Decompressor &_decompressor, const ROW &_row) {
+  try {
+    const auto values = _decompressor(BYTES(_row.data(), _row.size()));
+    return ROW(values.begin(), values.end());
+  } catch (const std::exception &) {
+    return {};
+  }
+}
+
+/// Random SASYZCRL commands with their operands.  The literal bytes of the
+/// last copy may be truncated.
+ROW random_rle_row(std::mt19937 &_gen) {
+  ROW row;
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::uniform_int_distribution<int> ncommands(1, 40);
+  auto pop = [&]() { return static_cast<uint8_t>(byte(_gen)); };
+  for (int i = ncommands(_gen); i > 0; --i) {
+    const uint8_t val = pop();
+    const uint8_t command = val >> 4;
+    const size_t end_of_first_byte = val & 0x0F;
+    // Keep the invalid commands rare
+    if (command >= 1 && command <= 3 && (val & 0x03))
+      continue;
+    row.push_back(val);
+    size_t ncopy = 0;
+    switch (command) {
+    case SAS_RLE_COMMAND_COPY64:
+      row.push_back(pop() & 0x3);
+      ncopy = (end_of_first_byte << 8) + row.back() + 64;
+      break;
+    case SAS_RLE_COMMAND_INSERT_BYTE18:
+      row.push_back(pop());
+      row.push_back(pop());
+      break;
+    case SAS_RLE_COMMAND_INSERT_AT17:
+    case SAS_RLE_COMMAND_INSERT_BLANK17:
+    case SAS_RLE_COMMAND_INSERT_ZERO17:
+    case SAS_RLE_COMMAND_INSERT_BYTE3:
+      row.push_back(pop());
+      break;
+    case SAS_RLE_COMMAND_COPY1:
+      ncopy = end_of_first_byte + 1;
+      break;
+    case SAS_RLE_COMMAND_COPY17:
+      ncopy = end_of_first_byte + 17;
+      break;
+    case SAS_RLE_COMMAND_COPY33:
+      ncopy = end_of_first_byte + 33;
+      break;
+    case SAS_RLE_COMMAND_COPY49:
+      ncopy = end_of_first_byte + 49;
+      break;
+    }
+    if (i == 1)
+      ncopy = std::uniform_int_distribution<size_t>(0, ncopy)(_gen);
+    for (; ncopy > 0; --ncopy)
+      row.push_back(pop());
+  }
+  return row;
+}
+
+/// Random SASYZCR2 control words with their literals and commands.  The
+/// pattern offsets are kept small to be mostly valid.
+ROW random_rdc_row(std::mt19937 &_gen) {
+  ROW row;
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::uniform_int_distribution<int> nwords(1, 8);
+  auto pop = [&]() { return static_cast<uint8_t>(byte(_gen)); };
+  for (int i = nwords(_gen); i > 0; --i) {
+    // Literals are more frequent
+    const uint16_t ctrl_bits = static_cast<uint16_t>(pop() & pop()) << 8 |
+                               static_cast<uint16_t>(pop() & pop());
+    row.push_back(static_cast<uint8_t>(ctrl_bits >> 8));
+    row.push_back(static_cast<uint8_t>(ctrl_bits));
+    for (uint16_t mask = 0x8000; mask; mask >>= 1) {
+      if ((ctrl_bits & mask) == 0) {
+        row.push_back(pop());
+        continue;
+      }
+      const uint8_t cmd = pop() >> 4;
+      row.push_back(static_cast<uint8_t>(cmd << 4 | (pop() & 0x0F)));
+      if (cmd == 0) {
+        row.push_back(pop());
+      } else if (cmd == 1 || cmd == 2) {
+        row.push_back(pop() & 0x03);
+        row.push_back(pop());
+      } else {
+        row.push_back(pop() & 0x01);
+      }
+    }
+  }
+  // Truncate the last control word
+  row.resize(row.size() -
+             std::uniform_int_distribution<size_t>(0, 8)(_gen) % row.size());
+  return row;
+}
+
+std::vector<ROW> &recorded_rows() {
+  static std::vector<ROW> instance;
+  return instance;
+}
+
+/// Collect the compressed rows read by READ_DATA.
+template <template <Endian, Format> class _Reference, Endian _endian,
+          Format _format>
+struct RECORDER : public _Reference<_endian, _format> {
+  explicit RECORDER(const Properties::Metadata *_metadata)
+      : _Reference<_endian, _format>(_metadata) {}
+
+  BYTES operator()(const BYTES &_values) {
+    recorded_rows().emplace_back(_values.begin(), _values.end());
+    return _Reference<_endian, _format>::operator()(_values);
+  }
+};
+
+using CORPUS = std::vector<std::pair<size_t, std::vector<ROW>>>;
+
+/// The row length and the compressed rows of the files of the test corpus
+/// compressed with _compression.
+template <template <Endian, Format> class _Reference>
+CORPUS compressed_corpus(const std::string &_compression) {
+  CORPUS corpus;
+  for (const auto &[filename, data] : files().j.items()) {
+    if (data["Header"]["compression"] != _compression)
+      continue;
+    Properties::Header header;
+    Properties::Metadata metadata;
+    auto rm = READ::metadata(Reader::build_source(datasource::ifstream(
+                                 convert_path(filename).c_str())),
+                             &header, &metadata, {});
+    recorded_rows().clear();
+    std::visit(
+        [&](auto &&arg) {
+          using T = std::decay_t<decltype(arg)>;
+          using DECOMPRESS = RECORDER<_Reference, T::endian, T::format>;
+          READ_DATA<DATASOURCE, T::endian, T::format, DECOMPRESS> rd(
+              std::move(arg), DECOMPRESS(&metadata), &metadata);
+          while (rd.read_line())
+            ;
+        },
+        std::move(rm));
+    corpus.emplace_back(metadata.row_length, std::move(recorded_rows()));
+  }
+  return corpus;
+}
+
+Properties::Metadata metadata_with_row_length(const size_t _row_length) {
+  Properties::Metadata metadata;
+  metadata.row_length = _row_length;
+  return metadata;
+}
+
+/// Total length of the rows of _corpus decompressed with _Decompressor.
+template <typename _Decompressor> size_t decompress(const CORPUS &_corpus) {
+  size_t n = 0;
+  for (const auto &[row_length, rows] : _corpus) {
+    const auto metadata = metadata_with_row_length(row_length);
+    _Decompressor decompressor(&metadata);
+    for (const auto &row : rows)
+      n += decompressor(BYTES(row.data(), row.size())).size();
+  }
+  return n;
+}
 } // namespace
 
 SCENARIO("When I pop values from a source, I get the expected values",
@@ -83,3 +407,164 @@ SCENARIO("I can store values in the destination",
     }
   }
 }
+
+SCENARIO("The RLE decompressor gives the same output as the reference decoder",
+         "[internal][decompressor][RLE]") {
+  GIVEN("Random SASYZCRL commands") {
+    std::mt19937 gen(20261017);
+    std::uniform_int_distribution<size_t> row_length(1, 2000);
+    THEN("The decompressed rows are identical") {
+      size_t nerrors = 0;
+      for (size_t i = 0; i < 2000; ++i) {
+        const auto metadata = metadata_with_row_length(row_length(gen));
+        RLE<Endian::little, Format::bit64> rle(&metadata);
+        RLE_REFERENCE<Endian::little, Format::bit64> reference(&metadata);
+        const auto row = random_rle_row(gen);
+        const auto test = decompress(rle, row);
+        const auto ref = decompress(reference, row);
+        if (ref.empty())
+          ++nerrors;
+        INFO("row " << i << " of length " << row.size());
+        REQUIRE(test == ref);
+      }
+      // Both the valid and invalid rows are covered
+      CHECK(nerrors > 0);
+      CHECK(nerrors < 2000);
+    }
+  }
+  GIVEN("The compressed rows of the test files") {
+    const auto corpus = compressed_corpus<RLE_REFERENCE>("SASYZCRL");
+    REQUIRE_FALSE(corpus.empty());
+    THEN("The decompressed rows are identical") {
+      for (const auto &[row_length, rows] : corpus) {
+        const auto metadata = metadata_with_row_length(row_length);
+        RLE<Endian::little, Format::bit64> rle(&metadata);
+        RLE<Endian::little, Format::bit64, ASSERT::NO> unchecked(&metadata);
+        RLE_REFERENCE<Endian::little, Format::bit64> reference(&metadata);
+        for (const auto &row : rows) {
+          const auto ref = decompress(reference, row);
+          REQUIRE(ref.size() == row_length);
+          REQUIRE(decompress(rle, row) == ref);
+          REQUIRE(decompress(unchecked, row) == ref);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("The RDC decompressor gives the same output as the reference decoder",
+         "[internal][decompressor][RDC]") {
+  GIVEN("Random SASYZCR2 control words and commands") {
+    std::mt19937 gen(20261017);
+    std::uniform_int_distribution<size_t> row_length(1, 1000);
+    THEN("The decompressed rows are identical") {
+      size_t nerrors = 0;
+      for (size_t i = 0; i < 2000; ++i) {
+        const auto metadata = metadata_with_row_length(row_length(gen));
+        RDC<Endian::little, Format::bit64> rdc(&metadata);
+        RDC_REFERENCE<Endian::little, Format::bit64> reference(&metadata);
+        const auto row = random_rdc_row(gen);
+        const auto test = decompress(rdc, row);
+        const auto ref = decompress(reference, row);
+        if (ref.empty())
+          ++nerrors;
+        INFO("row " << i << " of length " << row.size());
+        REQUIRE(test == ref);
+      }
+      // Both the valid and invalid rows are covered
+      CHECK(nerrors > 0);
+      CHECK(nerrors < 2000);
+    }
+  }
+  GIVEN("An overlapping pattern") {
+    const auto metadata = metadata_with_row_length(20);
+    RDC<Endian::little, Format::bit64> rdc(&metadata);
+    // 3 literals then a short pattern of 15 bytes from 3 bytes back
+    const ROW row{0x10, 0x00, 'a', 'b', 'c', 0xF0, 0x00, 0x00};
+    THEN("The pattern is repeated") {
+      const auto test = decompress(rdc, row);
+      CHECK(std::string(test.begin(), test.end()) ==
+            std::string("abcabcabcabcabcabc\0\0", 20));
+    }
+  }
+  GIVEN("The compressed rows of the test files") {
+    const auto corpus = compressed_corpus<RDC_REFERENCE>("SASYZCR2");
+    REQUIRE_FALSE(corpus.empty());
+    THEN("The decompressed rows are identical") {
+      for (const auto &[row_length, rows] : corpus) {
+        const auto metadata = metadata_with_row_length(row_length);
+        RDC<Endian::little, Format::bit64> rdc(&metadata);
+        RDC<Endian::little, Format::bit64, ASSERT::NO> unchecked(&metadata);
+        RDC_REFERENCE<Endian::little, Format::bit64> reference(&metadata);
+        for (const auto &row : rows) {
+          const auto ref = decompress(reference, row);
+          REQUIRE(ref.size() == row_length);
+          REQUIRE(decompress(rdc, row) == ref);
+          REQUIRE(decompress(unchecked, row) == ref);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("The decompression stops after the bytes read by the columns",
+         "[internal][decompressor][used_row_length]") {
+  auto metadata = metadata_with_row_length(40);
+  metadata.columns.emplace_back("a", "", "",
+                                FORMATTER::StringFormatter(0, 2));
+  GIVEN("A column filter keeping the 2 first bytes") {
+    THEN("Only those bytes are needed") {
+      CHECK(used_row_length(&metadata) == 2);
+      const auto full = metadata_with_row_length(40);
+      CHECK(used_row_length(&full) == 40);
+    }
+  }
+  GIVEN("A SASYZCRL row") {
+    // 2 blanks, 3 literals then 5 '@'
+    const ROW row{0xE0, 0x82, 'a', 'b', 'c', 0xD3, 0x00};
+    THEN("The row is zero filled once the columns are decompressed") {
+      RLE<Endian::little, Format::bit64> rle(&metadata);
+      const auto test = decompress(rle, row);
+      CHECK(std::string(test.begin(), test.end()) ==
+            std::string("  ") + std::string(38, '\0'));
+      const auto full = metadata_with_row_length(40);
+      RLE<Endian::little, Format::bit64> rle_full(&full);
+      const auto ref = decompress(rle_full, row);
+      CHECK(std::string(ref.begin(), ref.end()) ==
+            std::string("  abc") + std::string(5, '@') +
+                std::string(30, '\0'));
+    }
+  }
+  GIVEN("A SASYZCR2 row") {
+    // 3 literals then a pattern of 15 bytes from 3 bytes back
+    const ROW row{0x10, 0x00, 'a', 'b', 'c', 0xF0, 0x00, 0x00};
+    THEN("The row is zero filled once the columns are decompressed") {
+      RDC<Endian::little, Format::bit64> rdc(&metadata);
+      const auto test = decompress(rdc, row);
+      CHECK(std::string(test.begin(), test.end()) ==
+            std::string("abc") + std::string(37, '\0'));
+      const auto full = metadata_with_row_length(40);
+      RDC<Endian::little, Format::bit64> rdc_full(&full);
+      const auto ref = decompress(rdc_full, row);
+      CHECK(std::string(ref.begin(), ref.end()) ==
+            std::string("abcabcabcabcabcabc") + std::string(22, '\0'));
+    }
+  }
+}
+
+TEST_CASE("Benchmark of the decompressors", "[.][!benchmark]") {
+  using RLE64 = RLE<Endian::little, Format::bit64>;
+  using RLE_REFERENCE64 = RLE_REFERENCE<Endian::little, Format::bit64>;
+  using RDC64 = RDC<Endian::little, Format::bit64>;
+  using RDC_REFERENCE64 = RDC_REFERENCE<Endian::little, Format::bit64>;
+  using RLE_UNCHECKED64 = RLE<Endian::little, Format::bit64, ASSERT::NO>;
+  using RDC_UNCHECKED64 = RDC<Endian::little, Format::bit64, ASSERT::NO>;
+  const auto rle = compressed_corpus<RLE_REFERENCE>("SASYZCRL");
+  const auto rdc = compressed_corpus<RDC_REFERENCE>("SASYZCR2");
+  BENCHMARK("RLE reference") { return decompress<RLE_REFERENCE64>(rle); };
+  BENCHMARK("RLE") { return decompress<RLE64>(rle); };
+  BENCHMARK("RLE unchecked") { return decompress<RLE_UNCHECKED64>(rle); };
+  BENCHMARK("RDC reference") { return decompress<RDC_REFERENCE64>(rdc); };
+  BENCHMARK("RDC") { return decompress<RDC64>(rdc); };
+  BENCHMARK("RDC unchecked") { return decompress<RDC_UNCHECKED64>(rdc); };
+}
@@ -7,6 +7,7 @@
  */
 
 #include "../src/encodings.hpp"
+#include <cppsas7bdat/transcoder.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators_all.hpp>
 #include <fmt/core.h>
@@ -78,3 +79,72 @@ SCENARIO("I can get string representation of the encoding", "[encoding]") {
     }
   }
 }
+
+SCENARIO("The Transcoder converts the strings to UTF-8", "[encoding]") {
+  GIVEN("a WINDOWS-1252 transcoder") {
+    const cppsas7bdat::Transcoder transcoder("WINDOWS-1252");
+    CHECK(transcoder.is_supported());
+    CHECK(transcoder.to_utf8("") == "");
+    CHECK(transcoder.to_utf8("hello") == "hello");
+    CHECK(transcoder.to_utf8("caf\xE9") == "caf\xC3\xA9");
+    CHECK(transcoder.to_utf8("\x80 5") == "\xE2\x82\xAC 5");
+    CHECK(transcoder.to_utf8("\x81") == "\xEF\xBF\xBD");
+    THEN("The non-ASCII characters are found in long strings") {
+      for (size_t i = 0; i < 70; ++i) {
+        std::string s(70, 'a');
+        s[i] = '\xE9';
+        std::string ref(70, 'a');
+        ref.replace(i, 1, "\xC3\xA9");
+        INFO(i);
+        CHECK(transcoder.to_utf8(s) == ref);
+      }
+    }
+    THEN("The strings of a batch are converted into a buffer") {
+      const cppsas7bdat::SV src[3] = {"caf\xE9", "", "na\xEFve"};
+      std::string buffer = "garbage";
+      cppsas7bdat::SV out[3];
+      transcoder.to_utf8(src, 3, buffer, out);
+      CHECK(out[0] == "caf\xC3\xA9");
+      CHECK(out[1] == "");
+      CHECK(out[2] == "na\xC3\xAFve");
+      CHECK(buffer == "caf\xC3\xA9na\xC3\xAFve");
+    }
+  }
+  GIVEN("other single-byte encodings") {
+    CHECK(cppsas7bdat::Transcoder("CP437").to_utf8("\xB0") == "\xE2\x96\x91");
+    CHECK(cppsas7bdat::Transcoder("WINDOWS-1251").to_utf8("\xC0") ==
+          "\xD0\x90");
+    CHECK(cppsas7bdat::Transcoder("ISO-8859-1").to_utf8("\xFF") ==
+          "\xC3\xBF");
+    CHECK(cppsas7bdat::Transcoder("CP921").to_utf8("\xD0\xFF") ==
+          "\xC5\xA0\xE2\x80\x99");
+    CHECK(cppsas7bdat::Transcoder("CP922").to_utf8("\xDE\xE9") ==
+          "\xC5\xBD\xC3\xA9");
+  }
+  GIVEN("UTF-8 and the multi-byte encodings") {
+    for (const auto encoding : {"UTF-8", "US-ASCII", "BIG5-HKSCS", "CP950"}) {
+      const cppsas7bdat::Transcoder transcoder(encoding);
+      CHECK_FALSE(transcoder.is_supported());
+      CHECK(transcoder.to_utf8("caf\xC3\xA9") == "caf\xC3\xA9");
+    }
+  }
+  GIVEN("all the encodings") {
+    // Every byte of a supported encoding gives one character
+    for (int e = 0; e < 256; ++e) {
+      const auto encoding =
+          cppsas7bdat::INTERNAL::get_encoding(static_cast<uint8_t>(e));
+      const cppsas7bdat::Transcoder transcoder(encoding);
+      if (!transcoder.is_supported())
+        continue;
+      for (int c = 0; c < 256; ++c) {
+        const char x = static_cast<char>(c);
+        const auto s = transcoder.to_utf8(std::string_view(&x, 1));
+        INFO(encoding << " " << c);
+        if (c < 0x80)
+          CHECK(s == std::string(1, x));
+        else
+          CHECK((s.size() >= 2 && s.size() <= 3));
+      }
+    }
+  }
+}
@@ -12,6 +12,7 @@
 SCENARIO("I can throw the different exceptions") {
   CHECK_THROWS(cppsas7bdat::EXCEPTION::cannot_allocate_memory());
   CHECK_THROWS(cppsas7bdat::EXCEPTION::not_a_valid_file("filename"));
+  CHECK_THROWS(cppsas7bdat::EXCEPTION::cannot_write_file("filename"));
   CHECK_THROWS(cppsas7bdat::EXCEPTION::header_too_short());
   CHECK_THROWS(cppsas7bdat::EXCEPTION::invalid_magic_number());
   CHECK_THROWS(cppsas7bdat::EXCEPTION::cannot_read_page());
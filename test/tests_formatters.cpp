@@ -7,7 +7,9 @@
  */
 
 #include "../src/sas7bdat-impl.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <random>
 
 using namespace cppsas7bdat;
 using namespace cppsas7bdat::INTERNAL::FORMATTER;
@@ -303,3 +305,533 @@ SCENARIO("The TimeFormatter creates a IFormatter with the time type") {
     }
   }
 }
+
+SCENARIO("The formatters extract the values of a batch of rows at once") {
+  // 3 rows of 10 bytes: a string(2), a little endian int16 and a double
+  constexpr size_t row_length = 10;
+  uint8_t rows[3 * row_length] = {};
+  for (size_t irow = 0; irow < 3; ++irow) {
+    auto p = rows + irow * row_length;
+    p[0] = static_cast<uint8_t>('a' + irow);
+    p[1] = irow == 1 ? ' ' : 'z';
+    p[2] = static_cast<uint8_t>(irow);
+    const double x = 1.5 * static_cast<double>(irow);
+    std::memcpy(p + 2, &x, sizeof(x));
+  }
+  const void *pointers[3] = {rows + 2 * row_length, rows, rows + row_length};
+  const RowBatch contiguous{0, 3, nullptr, rows, row_length};
+  const RowBatch scattered{0, 3, pointers};
+
+  GIVEN("A batch of contiguous rows") {
+    THEN("The values are the same as one by one") {
+      SV strings[3];
+      NUMBER numbers[3];
+      INTEGER integers[3];
+      StringFormatter(0, 2).get_strings(contiguous, strings);
+      DoubleFormatter<Endian::little>(2, 8).get_numbers(contiguous, numbers);
+      SmallIntegerFormatter(0, 1).get_integers(contiguous, integers);
+      for (size_t irow = 0; irow < 3; ++irow) {
+        const void *p = rows + irow * row_length;
+        CHECK(strings[irow] == StringFormatter(0, 2).get_string(p));
+        CHECK(numbers[irow] == DoubleFormatter<Endian::little>(2, 8).get_number(p));
+        CHECK(integers[irow] == SmallIntegerFormatter(0, 1).get_integer(p));
+      }
+      CHECK(strings[1] == "b");
+      CHECK(numbers[2] == 3.0);
+    }
+  }
+  GIVEN("A batch of row pointers") {
+    THEN("The values are the same as one by one") {
+      SV strings[3];
+      NUMBER numbers[3];
+      INTEGER integers[3];
+      StringFormatter(0, 2).get_strings(scattered, strings);
+      DoubleFormatter<Endian::little>(2, 8).get_numbers(scattered, numbers);
+      IntegerFormatter<Endian::little, int16_t>(0, 2).get_integers(scattered,
+                                                                   integers);
+      for (size_t irow = 0; irow < 3; ++irow) {
+        CHECK(strings[irow] == StringFormatter(0, 2).get_string(pointers[irow]));
+        CHECK(numbers[irow] ==
+              DoubleFormatter<Endian::little>(2, 8).get_number(pointers[irow]));
+        CHECK(integers[irow] == IntegerFormatter<Endian::little, int16_t>(0, 2)
+                                    .get_integer(pointers[irow]));
+      }
+    }
+  }
+  GIVEN("The IFormatter") {
+    THEN("Missing values are returned") {
+      NUMBER numbers[3];
+      IFormatter(0, 8, Type::unknown).get_numbers(contiguous, numbers);
+      CHECK(std::isnan(numbers[0]));
+      CHECK(std::isnan(numbers[2]));
+    }
+  }
+}
+
+SCENARIO("The byte swap of runs of values gives the same values as one by "
+         "one") {
+  std::mt19937 gen(20261017);
+  std::vector<uint8_t> src(64 * 40);
+  for (auto &x : src)
+    x = static_cast<uint8_t>(gen());
+
+  auto check = [&](auto _size) {
+    constexpr size_t size = decltype(_size)::value;
+    for (const size_t stride : {size, size + 3, size_t{40}}) {
+      for (size_t n = 0; n <= 64 && n * stride <= src.size(); ++n) {
+        std::vector<uint8_t> test(n * size + 1, 0xAA), ref(n * size + 1, 0xAA);
+        INTERNAL::byteswap<size>(src.data(), stride, n, test.data());
+        for (size_t i = 0; i < n; ++i)
+          for (size_t k = 0; k < size; ++k)
+            ref[i * size + k] = src[i * stride + size - 1 - k];
+        INFO("size " << size << ", stride " << stride << ", n " << n);
+        REQUIRE(test == ref);
+      }
+    }
+  };
+  check(std::integral_constant<size_t, 2>{});
+  check(std::integral_constant<size_t, 4>{});
+  check(std::integral_constant<size_t, 8>{});
+}
+
+SCENARIO("The big endian formatters extract the values of a batch of rows at "
+         "once") {
+  // 37 rows of 11 bytes: a big endian double and int16
+  constexpr size_t nrows = 37, row_length = 11;
+  uint8_t rows[nrows * row_length] = {};
+  for (size_t irow = 0; irow < nrows; ++irow) {
+    auto p = rows + irow * row_length;
+    const double x = -1.25 * static_cast<double>(irow);
+    uint8_t b[8];
+    std::memcpy(b, &x, sizeof(x));
+    for (size_t k = 0; k < 8; ++k)
+      p[k] = b[7 - k];
+    p[8] = static_cast<uint8_t>(irow * 7);
+    p[9] = static_cast<uint8_t>(0x80 | irow);
+  }
+  const void *pointers[nrows];
+  for (size_t irow = 0; irow < nrows; ++irow)
+    pointers[irow] = rows + (nrows - 1 - irow) * row_length;
+  const DoubleFormatter<Endian::big> number(0, 8);
+  const IntegerFormatter<Endian::big, int16_t> integer(8, 2);
+
+  for (const auto &batch : {RowBatch{0, nrows, nullptr, rows, row_length},
+                            RowBatch{0, nrows, pointers}}) {
+    NUMBER numbers[nrows], integers_as_numbers[nrows];
+    INTEGER integers[nrows];
+    number.get_numbers(batch, numbers);
+    integer.get_integers(batch, integers);
+    integer.get_numbers(batch, integers_as_numbers);
+    for (size_t irow = 0; irow < nrows; ++irow) {
+      CHECK(numbers[irow] == number.get_number(batch[irow]));
+      CHECK(integers[irow] == integer.get_integer(batch[irow]));
+      CHECK(integers_as_numbers[irow] == integer.get_number(batch[irow]));
+    }
+  }
+  CHECK(DoubleFormatter<Endian::big>(0, 8).get_number(rows + row_length) ==
+        -1.25);
+}
+
+SCENARIO("The truncated doubles of a run are the same as one by one") {
+  std::mt19937 gen(20261017);
+  std::vector<uint8_t> src(48 * 40);
+  for (auto &x : src)
+    x = static_cast<uint8_t>(gen());
+
+  auto check = [&](auto _endian, auto _nbits) {
+    constexpr Endian endian = decltype(_endian)::value;
+    constexpr int nbits = decltype(_nbits)::value;
+    constexpr size_t n = nbits;
+    for (const size_t stride : {n, n + 1, size_t{40}}) {
+      for (size_t count = 0; count <= 48 && count * stride <= src.size();
+           ++count) {
+        std::vector<NUMBER> test(count);
+        INTERNAL::get_incomplete_doubles<endian, nbits>(src.data(), stride,
+                                                        count, test.data());
+        for (size_t i = 0; i < count; ++i) {
+          const double ref = INTERNAL::get_incomplete_double<endian, nbits>(
+              src.data() + i * stride);
+          INFO(nbits << " bytes, stride " << stride << ", value " << i);
+          // Bit for bit, including the NaN payloads
+          REQUIRE(std::memcmp(&test[i], &ref, sizeof(ref)) == 0);
+        }
+      }
+    }
+  };
+  auto check_nbits = [&](auto _endian) {
+    check(_endian, std::integral_constant<int, 3>{});
+    check(_endian, std::integral_constant<int, 4>{});
+    check(_endian, std::integral_constant<int, 5>{});
+    check(_endian, std::integral_constant<int, 6>{});
+    check(_endian, std::integral_constant<int, 7>{});
+  };
+  check_nbits(std::integral_constant<Endian, Endian::little>{});
+  check_nbits(std::integral_constant<Endian, Endian::big>{});
+}
+
+SCENARIO("The epochs are the boost values since 1970-01-01") {
+  using namespace boost::posix_time;
+  const ptime unix_epoch(boost::gregorian::date(1970, 1, 1));
+  std::mt19937 gen(20261017);
+  std::uniform_real_distribution<double> seconds(-4e9, 4e9);
+  std::uniform_real_distribution<double> days(-50000, 50000);
+
+  constexpr size_t n = 1000, row_length = 24;
+  std::vector<uint8_t> rows(n * row_length);
+  std::vector<double> values(n);
+  for (size_t i = 0; i < n; ++i) {
+    values[i] = i % 3 == 0 ? std::round(seconds(gen)) : seconds(gen);
+    if (i % 97 == 0)
+      values[i] = std::numeric_limits<double>::quiet_NaN();
+  }
+  values[1] = 0.;
+  values[2] = -0.4999;
+  for (size_t i = 0; i < n; ++i)
+    std::memcpy(rows.data() + i * row_length + 8, &values[i], 8);
+  const RowBatch batch{0, n, nullptr, rows.data(), row_length};
+  std::vector<EPOCH> epochs(n);
+
+  GIVEN("a DateTimeFormatter") {
+    const auto instance = DateTimeFormatter<Endian::little>(8, 8);
+    instance.get_epochs(batch, epochs.data());
+    for (size_t i = 0; i < n; ++i) {
+      const auto x = instance.get_datetime(batch[i]);
+      const auto ref = x.is_not_a_date_time()
+                           ? EPOCH_NA
+                           : (x - unix_epoch).total_microseconds();
+      INFO(values[i]);
+      REQUIRE(instance.get_epoch(batch[i]) == ref);
+      REQUIRE(epochs[i] == ref);
+    }
+  }
+  GIVEN("a TimeFormatter") {
+    const auto instance = TimeFormatter<Endian::little>(8, 8);
+    instance.get_epochs(batch, epochs.data());
+    for (size_t i = 0; i < n; ++i) {
+      const auto x = instance.get_time(batch[i]);
+      const auto ref =
+          x.is_not_a_date_time() ? EPOCH_NA : x.total_microseconds();
+      INFO(values[i]);
+      REQUIRE(instance.get_epoch(batch[i]) == ref);
+      REQUIRE(epochs[i] == ref);
+    }
+  }
+  GIVEN("a DateFormatter") {
+    for (size_t i = 0; i < n; ++i) {
+      const double d = i % 97 == 0 ? values[i] : days(gen) / 3.;
+      std::memcpy(rows.data() + i * row_length + 8, &d, 8);
+    }
+    const auto instance = DateFormatter<Endian::little>(8, 8);
+    instance.get_epochs(batch, epochs.data());
+    for (size_t i = 0; i < n; ++i) {
+      const auto x = instance.get_date(batch[i]);
+      const auto ref = x.is_not_a_date()
+                           ? EPOCH_NA
+                           : (x - unix_epoch.date()).days();
+      REQUIRE(instance.get_epoch(batch[i]) == ref);
+      REQUIRE(epochs[i] == ref);
+    }
+  }
+  GIVEN("a DoubleFormatter") {
+    const auto instance = DoubleFormatter<Endian::little>(8, 8);
+    instance.get_epochs(batch, epochs.data());
+    CHECK(instance.get_epoch(batch[1]) == EPOCH_NA);
+    CHECK(epochs[1] == EPOCH_NA);
+  }
+  GIVEN("datetimes at the limits of the EPOCH range") {
+    constexpr EPOCH offset = INTERNAL::SAS_TO_UNIX_DAYS * 86400;
+    CHECK(INTERNAL::get_unix_microseconds(9.2e12) ==
+          (9'200'000'000'000 - offset) * 1'000'000);
+    CHECK(INTERNAL::get_unix_microseconds(-9.2e12) ==
+          (-9'200'000'000'000 - offset) * 1'000'000);
+    // The microseconds since 1970-01-01 do not fit in an EPOCH.
+    for (const double x : {9.3e12, -9.3e12, 9.9e12, -9.9e12, 1e300}) {
+      INFO(x);
+      CHECK(INTERNAL::get_unix_microseconds(x) == EPOCH_NA);
+      CHECK(INTERNAL::get_day_microseconds(x) == EPOCH_NA);
+    }
+  }
+  GIVEN("dates inside and outside of the boost::gregorian dates") {
+    // Outside of the dates, the value is read as seconds by both.
+    for (const double x :
+         {0., -0.6, 2936549., 2936549.6, 3e6, -204535., -204536., 1e7, -1e7,
+          2.5e11, 2.6e11, -1e12, 9.9e12, std::nan("")}) {
+      INFO(x);
+      const auto date = INTERNAL::get_date_from_epoch(x);
+      if (date.is_not_a_date()) {
+        CHECK(INTERNAL::get_unix_days(x) == EPOCH_NA);
+      } else {
+        CHECK(INTERNAL::get_unix_days(x) ==
+              (date - boost::gregorian::date(1970, 1, 1)).days());
+      }
+    }
+    CHECK(INTERNAL::get_unix_days(2936549.) == 2932896);
+    CHECK(INTERNAL::get_unix_days(1e7) == -3538);
+    CHECK(INTERNAL::get_unix_days(2.6e11) == EPOCH_NA);
+  }
+}
+
+TEST_CASE("Benchmark of the epochs", "[.][!benchmark]") {
+  constexpr size_t nrows = 4096, stride = 40;
+  std::vector<uint8_t> rows(nrows * stride);
+  for (size_t i = 0; i < nrows; ++i) {
+    const double x = 1.7e9 + 1.25 * static_cast<double>(i);
+    std::memcpy(rows.data() + i * stride, &x, sizeof(x));
+  }
+  const RowBatch batch{0, nrows, nullptr, rows.data(), stride};
+  const auto instance = DateTimeFormatter<Endian::little>(0, 8);
+  std::vector<DATETIME> datetimes(nrows);
+  std::vector<EPOCH> epochs(nrows);
+  BENCHMARK("Datetimes") {
+    for (size_t i = 0; i < nrows; ++i)
+      datetimes[i] = instance.get_datetime(batch[i]);
+    return datetimes[nrows - 1];
+  };
+  BENCHMARK("Epochs one by one") {
+    for (size_t i = 0; i < nrows; ++i)
+      epochs[i] = instance.get_epoch(batch[i]);
+    return epochs[nrows - 1];
+  };
+  BENCHMARK("Epochs") {
+    instance.get_epochs(batch, epochs.data());
+    return epochs[nrows - 1];
+  };
+}
+
+SCENARIO("The missing values are decoded as a validity bitmap") {
+  // NaN with the SAS missing value code _code
+  auto missing = [](const char _code) {
+    const unsigned tag = _code == '_'   ? 0
+                         : _code == '.' ? 1
+                                        : static_cast<unsigned>(_code - 'A') + 2;
+    const uint64_t bits = 0xFFFF000000000000 | uint64_t{~tag & 0xFF} << 40;
+    double x;
+    std::memcpy(&x, &bits, sizeof(x));
+    return x;
+  };
+  CHECK(INTERNAL::get_missing_code(missing('_')) == '_');
+  CHECK(INTERNAL::get_missing_code(missing('.')) == '.');
+  CHECK(INTERNAL::get_missing_code(missing('A')) == 'A');
+  CHECK(INTERNAL::get_missing_code(missing('Z')) == 'Z');
+  CHECK(INTERNAL::get_missing_code(
+            std::numeric_limits<double>::quiet_NaN()) == '.');
+
+  const std::string codes = "._ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  std::mt19937 gen(20261017);
+  constexpr size_t n = 300, row_length = 16;
+  std::vector<double> values(n);
+  for (size_t i = 0; i < n; ++i)
+    values[i] = gen() % 3 ? static_cast<double>(gen()) - 1e9
+                          : missing(codes[gen() % codes.size()]);
+
+  auto check = [&](const auto &_formatter, const auto _store) {
+    std::vector<uint8_t> rows(n * row_length);
+    std::vector<const void *> prows(n);
+    for (size_t i = 0; i < n; ++i) {
+      _store(rows.data() + i * row_length + 4, values[i]);
+      prows[i] = rows.data() + i * row_length;
+    }
+    for (const size_t count : {size_t{0}, size_t{5}, size_t{64}, size_t{259},
+                               n}) {
+      for (const bool pointers : {false, true}) {
+        const RowBatch batch =
+            pointers ? RowBatch{0, count, prows.data()}
+                     : RowBatch{0, count, nullptr, rows.data(), row_length};
+        std::vector<uint8_t> validity((count + 7) / 8 + 1, 0xAA);
+        std::string test(count, '?');
+        _formatter.get_validity(batch, validity.data(), test.data());
+        INFO(count << " rows, pointers " << pointers);
+        for (size_t i = 0; i < count; ++i) {
+          const bool valid = !std::isnan(values[i]);
+          REQUIRE(((validity[i / 8] >> (i % 8)) & 1) == valid);
+          REQUIRE(test[i] ==
+                  (valid ? '\0' : INTERNAL::get_missing_code(values[i])));
+        }
+        if (count % 8)
+          CHECK(validity[count / 8] >> (count % 8) == 0);
+        CHECK(validity[(count + 7) / 8] == 0xAA);
+        _formatter.get_validity(batch, validity.data(), nullptr);
+      }
+    }
+  };
+  auto store_little = [](uint8_t *_p, const double _x) {
+    std::memcpy(_p, &_x, 8);
+  };
+  auto store_big = [](uint8_t *_p, const double _x) {
+    uint8_t buf[8];
+    std::memcpy(buf, &_x, 8);
+    std::reverse_copy(buf, buf + 8, _p);
+  };
+  auto store_little3 = [](uint8_t *_p, const double _x) {
+    uint8_t buf[8];
+    std::memcpy(buf, &_x, 8);
+    std::copy(buf + 5, buf + 8, _p);
+  };
+
+  GIVEN("a DoubleFormatter") {
+    check(DoubleFormatter<Endian::little>(4, 8), store_little);
+    check(DoubleFormatter<Endian::big>(4, 8), store_big);
+  }
+  GIVEN("a DateTimeFormatter") {
+    check(DateTimeFormatter<Endian::little>(4, 8), store_little);
+  }
+  GIVEN("an IncompleteDoubleFormatter") {
+    // The integers are exact on 3 bytes only if they are small
+    for (auto &x : values)
+      if (!std::isnan(x))
+        x = 1.;
+    check(IncompleteDoubleFormatter<Endian::little, 3>(4, 3), store_little3);
+    check(IncompleteDoubleFormatter<Endian::big, 3>(4, 3), store_big);
+  }
+  GIVEN("a StringFormatter") {
+    const auto instance = StringFormatter(0, 8);
+    std::vector<uint8_t> rows(16);
+    uint8_t validity[2];
+    char test[10];
+    instance.get_validity(RowBatch{0, 10, nullptr, rows.data(), 0}, validity,
+                          test);
+    CHECK(validity[0] == 0xFF);
+    CHECK(validity[1] == 0x03);
+    CHECK(std::count(test, test + 10, '\0') == 10);
+  }
+}
+
+TEST_CASE("Benchmark of the validity bitmaps", "[.][!benchmark]") {
+  constexpr size_t nrows = 4096, stride = 40;
+  std::vector<uint8_t> rows(nrows * stride);
+  for (size_t i = 0; i < nrows; ++i) {
+    const double x = i % 10 ? static_cast<double>(i)
+                            : std::numeric_limits<double>::quiet_NaN();
+    std::memcpy(rows.data() + i * stride, &x, sizeof(x));
+  }
+  const RowBatch batch{0, nrows, nullptr, rows.data(), stride};
+  const auto instance = DoubleFormatter<Endian::little>(0, 8);
+  std::vector<uint8_t> validity(nrows / 8);
+  std::vector<char> codes(nrows);
+  std::vector<NUMBER> numbers(nrows);
+  BENCHMARK("Numbers then scan for NaN") {
+    instance.get_numbers(batch, numbers.data());
+    for (size_t i = 0; i < nrows; ++i)
+      codes[i] = std::isnan(numbers[i]);
+    return codes[nrows - 1];
+  };
+  BENCHMARK("Validity") {
+    instance.get_validity(batch, validity.data(), nullptr);
+    return validity[nrows / 8 - 1];
+  };
+  BENCHMARK("Validity and codes") {
+    instance.get_validity(batch, validity.data(), codes.data());
+    return codes[nrows - 1];
+  };
+}
+
+SCENARIO("The strings are trimmed as with std::isspace in the C locale") {
+  // Reference: one byte at a time
+  auto trim = [](const uint8_t *_p, size_t _n) {
+    while (_n && (_p[_n - 1] == 0 || std::isspace(_p[_n - 1])))
+      --_n;
+    return std::string_view(reinterpret_cast<const char *>(_p), _n);
+  };
+  const uint8_t chars[] = {0,   ' ', '\t', '\n', '\v', '\f', '\r',
+                           0x08, 0x0E, 0x1F, 'a',  0x7F, 0xA0, 0xFF};
+  std::mt19937 gen(20261017);
+  std::vector<uint8_t> buf(100);
+  for (size_t trial = 0; trial < 20000; ++trial) {
+    const size_t n = gen() % buf.size();
+    // Mostly blanks, a few other characters
+    for (size_t i = 0; i < n; ++i)
+      buf[i] = gen() % 8 ? chars[gen() % 7] : chars[gen() % sizeof(chars)];
+    INFO(n);
+    REQUIRE(INTERNAL::get_string_trim_0(buf.data(), n) ==
+            trim(buf.data(), n));
+  }
+  for (int c = 0; c < 256; ++c) {
+    INFO(c);
+    CHECK(INTERNAL::is_space(static_cast<uint8_t>(c)) ==
+          (std::isspace(c) != 0));
+    CHECK(INTERNAL::is_print(static_cast<uint8_t>(c)) ==
+          (std::isprint(c) != 0));
+  }
+}
+
+TEST_CASE("Benchmark of the string trimming", "[.][!benchmark]") {
+  constexpr size_t nrows = 4096, length = 200;
+  std::vector<uint8_t> rows(nrows * length, ' ');
+  for (size_t i = 0; i < nrows; ++i)
+    std::memcpy(rows.data() + i * length, "value", 5);
+  const RowBatch batch{0, nrows, nullptr, rows.data(), length};
+  const auto instance = StringFormatter(0, length);
+  std::vector<SV> out(nrows);
+  BENCHMARK("One byte at a time") {
+    for (size_t i = 0; i < nrows; ++i) {
+      const uint8_t *p = rows.data() + i * length;
+      size_t n = length;
+      while (n && (p[n - 1] == 0 || std::isspace(p[n - 1])))
+        --n;
+      out[i] = SV(reinterpret_cast<const char *>(p), n);
+    }
+    return out[nrows - 1];
+  };
+  BENCHMARK("get_strings") {
+    instance.get_strings(batch, out.data());
+    return out[nrows - 1];
+  };
+}
+
+TEST_CASE("Benchmark of the truncated doubles", "[.][!benchmark]") {
+  constexpr size_t nrows = 4096, stride = 40;
+  std::vector<uint8_t> rows(nrows * stride + 8, 0x3F);
+  std::vector<NUMBER> out(nrows);
+  BENCHMARK("Little endian 4 bytes one by one") {
+    for (size_t i = 0; i < nrows; ++i)
+      out[i] = INTERNAL::get_incomplete_double<Endian::little, 4>(
+          rows.data() + 8 + i * stride);
+    return out[nrows - 1];
+  };
+  BENCHMARK("Little endian 4 bytes run") {
+    INTERNAL::get_incomplete_doubles<Endian::little, 4>(
+        rows.data() + 8, stride, nrows, out.data());
+    return out[nrows - 1];
+  };
+  BENCHMARK("Big endian 3 bytes one by one") {
+    for (size_t i = 0; i < nrows; ++i)
+      out[i] = INTERNAL::get_incomplete_double<Endian::big, 3>(
+          rows.data() + 8 + i * stride);
+    return out[nrows - 1];
+  };
+  BENCHMARK("Big endian 3 bytes run") {
+    INTERNAL::get_incomplete_doubles<Endian::big, 3>(rows.data() + 8, stride,
+                                                     nrows, out.data());
+    return out[nrows - 1];
+  };
+}
+
+TEST_CASE("Benchmark of the byte swap", "[.][!benchmark]") {
+  constexpr size_t nrows = 4096;
+  for (const size_t stride : {size_t{8}, size_t{40}}) {
+    std::vector<uint8_t> rows(nrows * stride, 0x3F);
+    std::vector<NUMBER> out(nrows);
+    BENCHMARK(fmt::format("Double one by one, stride {}", stride)) {
+      for (size_t i = 0; i < nrows; ++i)
+        out[i] = INTERNAL::get_double<Endian::big>(rows.data() + i * stride);
+      return out[nrows - 1];
+    };
+    BENCHMARK(fmt::format("Double byte swap, stride {}", stride)) {
+      INTERNAL::get_vals<Endian::big, double>(rows.data(), stride, nrows,
+                                              out.data());
+      return out[nrows - 1];
+    };
+    std::vector<INTEGER> integers(nrows);
+    BENCHMARK(fmt::format("Int16 one by one, stride {}", stride)) {
+      for (size_t i = 0; i < nrows; ++i)
+        integers[i] =
+            INTERNAL::get_val<Endian::big, int16_t>(rows.data() + i * stride);
+      return integers[nrows - 1];
+    };
+    BENCHMARK(fmt::format("Int16 byte swap, stride {}", stride)) {
+      INTERNAL::get_vals<Endian::big, int16_t>(rows.data(), stride, nrows,
+                                               integers.data());
+      return integers[nrows - 1];
+    };
+  }
+}
@@ -6,16 +6,26 @@
  *  \author  Olivia Quinet
  */
 
+#include "../include/cppsas7bdat/decode_plan.hpp"
 #include "../include/cppsas7bdat/sink/null.hpp"
 #include "../include/cppsas7bdat/source/ifstream.hpp"
+#include "../include/cppsas7bdat/source/mmap.hpp"
+#include "../include/cppsas7bdat/source/prefetch.hpp"
+#include "../include/cppsas7bdat/source/trusted.hpp"
+#include "../include/cppsas7bdat/source/uring.hpp"
 #include "../include/cppsas7bdat/reader.hpp"
 
 #include "data.hpp"
 
+#include <boost/endian/conversion.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators_all.hpp>
+#include <filesystem>
 #include <fmt/core.h>
 #include <fmt/ostream.h>
+#include <fstream>
+#include <functional>
 
 using namespace cppsas7bdat;
 
@@ -278,7 +288,7 @@ struct MyTestDataSink {
 
 SCENARIO("When I read a file with the public interface, the properties and "
          "data are read properly",
-         "[inteface][read_data]") {
+         "[interface][read_data]") {
   const auto data =
       GENERATE(from_range(files().j.items().begin(), files().j.items().end()));
 
@@ -353,3 +363,1145 @@ SCENARIO("When I read a file with the public interface, the properties and "
     }
   }
 }
+
+namespace {
+/// A data source and its depth (pages in flight) if it has one.
+struct SourceSpec {
+  std::string name;
+  size_t depth{0};
+};
+
+template <typename _Sink>
+cppsas7bdat::Reader make_reader(const SourceSpec &_spec,
+                                const std::string &_filename, _Sink &&_sink) {
+  using namespace cppsas7bdat::datasource;
+  const auto path = convert_path(_filename);
+  if (_spec.name == "ifstream")
+    return cppsas7bdat::Reader(ifstream(path.c_str()),
+                               std::forward<_Sink>(_sink));
+  if (_spec.name == "mmap")
+    return cppsas7bdat::Reader(mmap(path.c_str()), std::forward<_Sink>(_sink));
+  if (_spec.name == "prefetch")
+    return cppsas7bdat::Reader(prefetch(ifstream(path.c_str()), _spec.depth),
+                               std::forward<_Sink>(_sink));
+  if (_spec.name == "uring")
+    return cppsas7bdat::Reader(uring(path.c_str(), _spec.depth),
+                               std::forward<_Sink>(_sink));
+  if (_spec.name == "trusted(ifstream)")
+    return cppsas7bdat::Reader(trusted(ifstream(path.c_str())),
+                               std::forward<_Sink>(_sink));
+  if (_spec.name == "trusted(mmap)")
+    return cppsas7bdat::Reader(trusted(mmap(path.c_str())),
+                               std::forward<_Sink>(_sink));
+  FAIL("Unknown data source " << _spec.name);
+  return {};
+}
+} // namespace
+
+SCENARIO("When I read a file with another datasource, the properties and "
+         "data are the same as with the ifstream datasource",
+         "[interface][read_data][datasource]") {
+  const auto data =
+      GENERATE(from_range(files().j.items().begin(), files().j.items().end()));
+  const auto spec = GENERATE(values<SourceSpec>({{"mmap"},
+                                                 {"prefetch", 1},
+                                                 {"prefetch", 4},
+                                                 {"uring", 1},
+                                                 {"uring", 8},
+                                                 {"trusted(ifstream)"},
+                                                 {"trusted(mmap)"}}));
+
+  const std::string filename = data.key();
+  const auto ref_header = data.value()["Header"];
+  const auto ref_columns = data.value()["Columns"];
+  auto ref_data = data.value()["Data"].items();
+
+  GIVEN(fmt::format("A file {} and the {} datasource (depth {}),", filename,
+                    spec.name, spec.depth)) {
+    // Skip big5 files
+    if (filename.find("big5") != filename.npos)
+      return;
+    WHEN("The data is read") {
+      auto reader =
+          make_reader(spec, filename,
+                      MyTestDataSink(ref_header, ref_columns, ref_data.begin(),
+                                     ref_data.end()));
+      THEN("The data values are correct - read_all") {
+        reader.read_all();
+        CHECK(reader.current_row_index() ==
+              reader.properties() /*.metadata*/.row_count);
+      }
+      THEN("The data values are correct - read_all with 2 threads") {
+        reader.read_all(2);
+        CHECK(reader.current_row_index() ==
+              reader.properties() /*.metadata*/.row_count);
+      }
+      THEN("The data values are correct - read_row") {
+        while (reader.read_row())
+          ;
+        CHECK(reader.current_row_index() ==
+              reader.properties() /*.metadata*/.row_count);
+      }
+      THEN("I can skip rows") {
+        size_t irow{0}, ref_irow{0};
+        for (auto ref_row : ref_data) {
+          {
+            const std::string line = ref_row.key();
+            std::from_chars(line.data(), line.data() + line.size(), ref_irow);
+          }
+          CHECK(reader.skip(ref_irow - irow) == true);
+          CHECK(reader.read_row() == true);
+          irow = ref_irow + 1;
+        }
+        CHECK(reader.current_row_index() ==
+              reader.properties() /*.metadata*/.row_count);
+      }
+    }
+  }
+}
+
+SCENARIO("When I try to read with the mmap datasource a non existing file or "
+         "a file too short, an exception is thrown",
+         "[interface][not_a_valid_file][mmap]") {
+  GIVEN("An invalid path") {
+    THEN("An exception is thrown") {
+      CHECK_THROWS(cppsas7bdat::datasource::mmap(invalid_path.c_str()));
+    }
+  }
+  GIVEN("A path to a too short file") {
+    THEN("an exception is thrown") {
+      CHECK_THROWS(cppsas7bdat::Reader(
+          cppsas7bdat::datasource::mmap(file_too_short.c_str()),
+          cppsas7bdat::datasink::null()));
+    }
+  }
+}
+
+SCENARIO("When I try to read with the uring datasource a non existing file or "
+         "a file too short, an exception is thrown",
+         "[interface][not_a_valid_file][uring]") {
+  GIVEN("An invalid path") {
+    THEN("An exception is thrown") {
+      CHECK_THROWS(cppsas7bdat::datasource::uring(invalid_path.c_str()));
+    }
+  }
+  GIVEN("A path to a too short file") {
+    THEN("an exception is thrown") {
+      CHECK_THROWS(cppsas7bdat::Reader(
+          cppsas7bdat::datasource::uring(file_too_short.c_str()),
+          cppsas7bdat::datasink::null()));
+    }
+  }
+}
+
+SCENARIO("The uring datasource reads the pages ahead again once back within "
+         "them after a seek outside of them",
+         "[interface][seek][uring]") {
+  GIVEN("A file with several pages,") {
+    const auto path = convert_path("data_poe/nls.sas7bdat");
+    const Properties::Header header =
+        get_reader("data_poe/nls.sas7bdat").properties();
+    const size_t page_length = header.page_length;
+    std::vector<uint8_t> head(header.header_length), page(page_length);
+    cppsas7bdat::datasource::uring source(path.c_str(), 2);
+    REQUIRE(source.read_bytes(head.data(), head.size()));
+    source.set_header(header);
+    REQUIRE(source.size() >= header.header_length + 3 * page_length);
+    REQUIRE(source.read_bytes_at(page.data(), page_length,
+                                 header.header_length));
+    WHEN("I seek into the header and read it again") {
+      REQUIRE(source.seek(0));
+      REQUIRE(source.read_bytes(head.data(), head.size()));
+      THEN("The pages are served from the pages read ahead") {
+        const auto view = static_cast<const uint8_t *>(
+            source.view_bytes(page_length));
+        REQUIRE(view);
+        CHECK(std::equal(page.begin(), page.end(), view));
+      }
+    }
+    WHEN("I seek past the last page and back to the first one") {
+      REQUIRE(source.seek(source.size()));
+      REQUIRE(source.seek(header.header_length));
+      THEN("The pages are served from the pages read ahead") {
+        CHECK(source.tell() == header.header_length);
+        const auto view = static_cast<const uint8_t *>(
+            source.view_bytes(page_length));
+        REQUIRE(view);
+        CHECK(std::equal(page.begin(), page.end(), view));
+      }
+    }
+  }
+}
+
+SCENARIO("The prefetch datasource reports the pages read ahead",
+         "[interface][read_data][prefetch]") {
+  const size_t depth = GENERATE(1, 4);
+  GIVEN(fmt::format("A depth of {},", depth)) {
+    cppsas7bdat::datasource::prefetch source(
+        cppsas7bdat::datasource::ifstream(file1.c_str()), depth);
+    const auto stats = source.get_statistics();
+    auto reader =
+        cppsas7bdat::Reader(std::move(source), cppsas7bdat::datasink::null());
+    reader.read_all();
+    THEN("Pages have been read") { CHECK(stats->pages > 0); }
+  }
+}
+
+SCENARIO("The data sources provide random access to the file",
+         "[interface][seek]") {
+  const std::string filename = GENERATE(from_range(
+      std::vector<std::string>{"data_AHS2013/omov.sas7bdat",
+                               "data_poe/nls.sas7bdat"}));
+
+  auto check = [](cppsas7bdat::Reader::PSOURCE &&_source) {
+    REQUIRE(_source->is_seekable());
+    std::vector<uint8_t> head(256), part(16), at(16);
+    REQUIRE(_source->read_bytes(head.data(), head.size()));
+    CHECK(_source->tell() == head.size());
+    CHECK(_source->size() > head.size());
+    CHECK(_source->seek(100));
+    CHECK(_source->tell() == 100);
+    REQUIRE(_source->read_bytes(part.data(), part.size()));
+    CHECK(std::equal(part.begin(), part.end(), head.begin() + 100));
+    CHECK(_source->tell() == 116);
+    REQUIRE(_source->read_bytes_at(at.data(), at.size(), 8));
+    CHECK(std::equal(at.begin(), at.end(), head.begin() + 8));
+    CHECK(_source->tell() == 116);
+    CHECK(_source->seek(_source->size()));
+    CHECK_FALSE(_source->read_bytes(part.data(), part.size()));
+    CHECK(_source->eof());
+  };
+
+  GIVEN(fmt::format("A file {},", filename)) {
+    const auto path = convert_path(filename);
+    WHEN("The data source is ifstream") {
+      check(cppsas7bdat::Reader::build_source(
+          cppsas7bdat::datasource::ifstream(path.c_str())));
+    }
+    WHEN("The data source is mmap") {
+      check(cppsas7bdat::Reader::build_source(
+          cppsas7bdat::datasource::mmap(path.c_str())));
+    }
+    WHEN("The data source is uring") {
+      check(cppsas7bdat::Reader::build_source(
+          cppsas7bdat::datasource::uring(path.c_str())));
+    }
+    WHEN("The data source cannot seek backward") {
+      struct forward_seek {
+        cppsas7bdat::datasource::ifstream source;
+
+        bool eof() { return source.eof(); }
+        bool read_bytes(void *_p, const size_t _length) {
+          return source.read_bytes(_p, _length);
+        }
+        size_t size() const noexcept { return source.size(); }
+        size_t tell() { return source.tell(); }
+        bool seek(const size_t _position) {
+          return _position >= source.tell() && source.seek(_position);
+        }
+      };
+      auto source = cppsas7bdat::Reader::build_source(
+          forward_seek{cppsas7bdat::datasource::ifstream(path.c_str())});
+      std::vector<uint8_t> at(16);
+      THEN("A positional read fails if the position cannot be restored") {
+        CHECK_FALSE(source->read_bytes_at(at.data(), at.size(), 100));
+      }
+    }
+  }
+}
+
+namespace {
+struct forward_only {
+  cppsas7bdat::datasource::ifstream source;
+
+  bool eof() { return source.eof(); }
+  bool read_bytes(void *_p, const size_t _length) {
+    return source.read_bytes(_p, _length);
+  }
+};
+} // namespace
+
+SCENARIO("When I skip rows with a data source that is not seekable, the data "
+         "are the same as with a seekable data source",
+         "[interface][read_data][skip]") {
+  const auto data =
+      GENERATE(from_range(files().j.items().begin(), files().j.items().end()));
+
+  const std::string filename = data.key();
+  const auto ref_header = data.value()["Header"];
+  const auto ref_columns = data.value()["Columns"];
+  auto ref_data = data.value()["Data"].items();
+
+  GIVEN(fmt::format("A file {},", filename)) {
+    // Skip big5 files
+    if (filename.find("big5") != filename.npos)
+      return;
+    WHEN("The data is read") {
+      auto reader = cppsas7bdat::Reader(
+          forward_only{
+              cppsas7bdat::datasource::ifstream(convert_path(filename).c_str())},
+          MyTestDataSink(ref_header, ref_columns, ref_data.begin(),
+                         ref_data.end()));
+      THEN("I can skip rows") {
+        size_t irow{0}, ref_irow{0};
+        for (auto ref_row : ref_data) {
+          {
+            const std::string line = ref_row.key();
+            std::from_chars(line.data(), line.data() + line.size(), ref_irow);
+          }
+          CHECK(reader.skip(ref_irow - irow) == true);
+          CHECK(reader.read_row() == true);
+          irow = ref_irow + 1;
+        }
+        CHECK(reader.current_row_index() ==
+              reader.properties() /*.metadata*/.row_count);
+      }
+    }
+    WHEN("I skip all the rows") {
+      auto reader = get_reader(filename);
+      const size_t row_count = reader.properties() /*.metadata*/.row_count;
+      THEN("The reader is at the end of the data") {
+        CHECK(reader.skip(row_count) == true);
+        CHECK(reader.current_row_index() == row_count);
+        CHECK(reader.read_row() == false);
+      }
+      THEN("I cannot skip more rows than available") {
+        CHECK(reader.skip(row_count + 1) == false);
+        CHECK(reader.current_row_index() == row_count);
+      }
+    }
+  }
+}
+
+SCENARIO("When I seek rows with the page index, the data are the same as when "
+         "the rows are read sequentially",
+         "[interface][page_index]") {
+  const auto data =
+      GENERATE(from_range(files().j.items().begin(), files().j.items().end()));
+  const auto spec =
+      GENERATE(values<SourceSpec>({{"ifstream"}, {"prefetch", 2}}));
+
+  const std::string filename = data.key();
+
+  GIVEN(fmt::format("A file {} and the {} datasource,", filename, spec.name)) {
+    // Skip big5 files
+    if (filename.find("big5") != filename.npos)
+      return;
+    auto reader = make_reader(spec, filename, cppsas7bdat::datasink::null());
+    const size_t row_count = reader.properties() /*.metadata*/.row_count;
+    const size_t row_length = reader.properties() /*.metadata*/.row_length;
+    WHEN("The page index is built") {
+      const auto &index = reader.page_index();
+      THEN("It covers all the rows") {
+        size_t nrows{0};
+        for (const auto &page : index.pages) {
+          CHECK(page.first_row == nrows);
+          nrows += page.row_count;
+        }
+        CHECK(nrows == row_count);
+        if (row_count) {
+          CHECK(index.find(0) < index.pages.size());
+          CHECK(index.find(row_count - 1) < index.pages.size());
+        }
+        CHECK(index.find(row_count) == index.pages.size());
+      }
+      THEN("It can be saved and loaded back") {
+        const auto tmp = std::filesystem::temp_directory_path();
+        const auto copy = (tmp / "cppsas7bdat_page_index.sas7bdat").string();
+        const auto sidecar = (tmp / "cppsas7bdat_page_index.idx").string();
+        std::filesystem::copy_file(convert_path(filename), copy,
+                                   std::filesystem::copy_options::overwrite_existing);
+        index.save(sidecar.c_str(), copy.c_str());
+        const auto loaded = PageIndex::load(sidecar.c_str(), copy.c_str());
+        REQUIRE(loaded.has_value());
+        CHECK(loaded->pages == index.pages);
+        // The file has changed => the index is stale.
+        std::ofstream(copy, std::ios::binary | std::ios::app).put('\0');
+        CHECK_FALSE(PageIndex::load(sidecar.c_str(), copy.c_str()));
+        std::filesystem::remove(sidecar);
+        std::filesystem::remove(copy);
+        CHECK_FALSE(PageIndex::load(sidecar.c_str(), copy.c_str()));
+      }
+    }
+    std::vector<std::vector<uint8_t>> rows;
+    {
+      auto sequential = get_reader(filename);
+      while (auto p = sequential.read_row_no_sink()) {
+        const auto *b = static_cast<const uint8_t *>(p);
+        rows.emplace_back(b, b + row_length);
+      }
+    }
+    WHEN("The page index is built in the middle of the read") {
+      THEN("The rows are the same") {
+        REQUIRE(rows.size() == row_count);
+        for (size_t irow = 0; irow < row_count; ++irow) {
+          if (irow == row_count / 2)
+            CHECK(reader.page_index().pages.size() > 0);
+          auto p = reader.read_row_no_sink();
+          REQUIRE(p);
+          CHECK(std::equal(rows[irow].begin(), rows[irow].end(),
+                           static_cast<const uint8_t *>(p)));
+        }
+        CHECK_FALSE(reader.read_row_no_sink());
+      }
+    }
+    WHEN("The rows are read backward with seek") {
+      THEN("The rows are the same") {
+        REQUIRE(rows.size() == row_count);
+        const size_t step = std::max<size_t>(1, row_count / 97);
+        for (size_t irow = row_count; irow-- > 0;) {
+          if (irow % step)
+            continue;
+          REQUIRE(reader.seek(irow));
+          CHECK(reader.current_row_index() == irow);
+          auto p = reader.read_row_no_sink();
+          REQUIRE(p);
+          CHECK(std::equal(rows[irow].begin(), rows[irow].end(),
+                           static_cast<const uint8_t *>(p)));
+        }
+        CHECK(reader.seek(row_count));
+        CHECK_FALSE(reader.read_row_no_sink());
+        CHECK_FALSE(reader.seek(row_count + 1));
+      }
+    }
+  }
+}
+
+SCENARIO("When I read a file with several threads, the data are pushed to the "
+         "sink in order",
+         "[interface][read_data][threads]") {
+  const auto data =
+      GENERATE(from_range(files().j.items().begin(), files().j.items().end()));
+  const size_t nthreads = GENERATE(2, 4);
+
+  const std::string filename = data.key();
+  const auto ref_header = data.value()["Header"];
+  const auto ref_columns = data.value()["Columns"];
+  auto ref_data = data.value()["Data"].items();
+
+  GIVEN(fmt::format("A file {} and {} threads,", filename, nthreads)) {
+    // Skip big5 files
+    if (filename.find("big5") != filename.npos)
+      return;
+    WHEN("The data is read") {
+      auto reader = get_reader(filename, MyTestDataSink(ref_header, ref_columns,
+                                                        ref_data.begin(),
+                                                        ref_data.end()));
+      THEN("The data values are correct - read_all") {
+        reader.read_all(nthreads);
+        CHECK(reader.current_row_index() ==
+              reader.properties() /*.metadata*/.row_count);
+      }
+    }
+    WHEN("The data is read after a skip") {
+      const size_t row_count = ref_header["row_count"];
+      auto it = ref_data.begin();
+      size_t irow{0};
+      for (; it != ref_data.end(); ++it) {
+        const std::string line = it.key();
+        std::from_chars(line.data(), line.data() + line.size(), irow);
+        if (irow >= row_count / 3)
+          break;
+      }
+      if (it == ref_data.end())
+        return;
+      auto reader = get_reader(
+          filename, MyTestDataSink(ref_header, ref_columns, std::move(it),
+                                   ref_data.end()));
+      THEN("The data values are correct - read_all") {
+        CHECK(reader.skip(irow) == true);
+        reader.read_all(nthreads);
+        CHECK(reader.current_row_index() == row_count);
+      }
+    }
+  }
+}
+
+SCENARIO("When I split a file into partitions, each partition reads its own "
+         "rows with the global row indices",
+         "[interface][read_data][partition]") {
+  const auto data =
+      GENERATE(from_range(files().j.items().begin(), files().j.items().end()));
+  const size_t count = GENERATE(1, 3, 7);
+
+  const std::string filename = data.key();
+  const auto ref_header = data.value()["Header"];
+  const auto ref_columns = data.value()["Columns"];
+  auto ref_data = data.value()["Data"].items();
+
+  GIVEN(fmt::format("A file {} and {} partitions,", filename, count)) {
+    // Skip big5 files
+    if (filename.find("big5") != filename.npos)
+      return;
+    auto reader = get_reader(filename);
+    const size_t row_count = reader.properties() /*.metadata*/.row_count;
+    const auto partitions = reader.partitions(count);
+    THEN("The partitions cover all the rows") {
+      CHECK(partitions.size() <= count);
+      size_t irow{0};
+      for (const auto &partition : partitions) {
+        CHECK(partition.first_row == irow);
+        CHECK(partition.first_row < partition.end_row);
+        irow = partition.end_row;
+      }
+      CHECK(irow == row_count);
+    }
+    auto check = [&](auto &&_make_source) {
+      for (const auto &partition : partitions) {
+        auto it = ref_data.begin();
+        size_t ref_irow{0};
+        for (; it != ref_data.end(); ++it) {
+          const std::string line = it.key();
+          std::from_chars(line.data(), line.data() + line.size(), ref_irow);
+          if (ref_irow >= partition.first_row)
+            break;
+        }
+        auto part = reader.partition(
+            partition, _make_source(),
+            MyTestDataSink(ref_header, ref_columns, std::move(it),
+                           ref_data.end()));
+        CHECK(part.current_row_index() == partition.first_row);
+        CHECK(&part.properties() == &reader.properties());
+        part.read_all();
+        CHECK(part.current_row_index() == partition.end_row);
+      }
+    };
+    WHEN("The partitions are read with a seekable data source") {
+      check([&]() {
+        return cppsas7bdat::datasource::ifstream(
+            convert_path(filename).c_str());
+      });
+    }
+    WHEN("The partitions are read with the prefetch data source") {
+      check([&]() {
+        return cppsas7bdat::datasource::prefetch(
+            cppsas7bdat::datasource::ifstream(convert_path(filename).c_str()),
+            2);
+      });
+    }
+    WHEN("The partitions are read with a data source that is not seekable") {
+      check([&]() {
+        return forward_only{
+            cppsas7bdat::datasource::ifstream(convert_path(filename).c_str())};
+      });
+    }
+  }
+}
+
+namespace {
+struct BatchSink {
+  std::vector<std::vector<uint8_t>> *rows{nullptr};
+  size_t row_length{0};
+  size_t batches{0};
+
+  void set_properties(const Properties &_properties) {
+    row_length = _properties /*.metadata*/.row_length;
+  }
+  void push_row(const size_t, Column::PBUF) { CHECK(false); }
+  void push_rows(const RowBatch &_rows) {
+    CHECK(_rows.first_row == rows->size());
+    // The rows of a page, compressed or not, are stored contiguously
+    CHECK(_rows.rows == nullptr);
+    CHECK(_rows.stride == row_length);
+    for (size_t i = 0; i < _rows.size(); ++i) {
+      const auto p = static_cast<const uint8_t *>(_rows[i]);
+      rows->emplace_back(p, p + row_length);
+    }
+    ++batches;
+  }
+  void end_of_data() const noexcept {}
+};
+} // namespace
+
+SCENARIO("When I read a file with a sink accepting batches of rows, the rows "
+         "are the same as when they are read one by one",
+         "[interface][read_data][push_rows]") {
+  const auto data =
+      GENERATE(from_range(files().j.items().begin(), files().j.items().end()));
+  const size_t nthreads = GENERATE(1, 2);
+
+  const std::string filename = data.key();
+
+  GIVEN(fmt::format("A file {} and {} threads,", filename, nthreads)) {
+    // Skip big5 files
+    if (filename.find("big5") != filename.npos)
+      return;
+    std::vector<std::vector<uint8_t>> ref_rows, rows;
+    {
+      auto reader = get_reader(filename);
+      const size_t row_length = reader.properties() /*.metadata*/.row_length;
+      while (auto p = reader.read_row_no_sink()) {
+        const auto *b = static_cast<const uint8_t *>(p);
+        ref_rows.emplace_back(b, b + row_length);
+      }
+    }
+    WHEN("The data is read") {
+      auto reader = get_reader(filename, BatchSink{&rows});
+      reader.read_all(nthreads);
+      THEN("The rows are the same") {
+        CHECK(reader.current_row_index() == ref_rows.size());
+        REQUIRE(rows.size() == ref_rows.size());
+        CHECK(rows == ref_rows);
+      }
+    }
+  }
+}
+
+namespace {
+struct ValueSink {
+  std::set<std::string> names;
+  std::vector<std::string> *values;
+  COLUMNS columns;
+
+  void set_properties(const Properties &_properties) {
+    for (const auto &column : _properties.columns)
+      if (names.count(column.name))
+        columns.push_back(column);
+  }
+  void push_row(const size_t, Column::PBUF _p) {
+    std::string s;
+    for (const auto &column : columns)
+      s += column.to_string(_p) + '|';
+    values->push_back(s);
+  }
+  void end_of_data() const noexcept {}
+};
+} // namespace
+
+SCENARIO("When I read a compressed file with a column filter, the values of "
+         "the selected columns are the same as without the filter",
+         "[interface][read_data][filter]") {
+  const auto data =
+      GENERATE(from_range(files().j.items().begin(), files().j.items().end()));
+
+  const std::string filename = data.key();
+  const auto ref_columns = data.value()["Columns"];
+
+  GIVEN(fmt::format("A file {},", filename)) {
+    if (data.value()["Header"]["compression"].is_null() ||
+        ref_columns.empty())
+      return;
+    // The first column and one in the middle
+    const std::set<std::string> names{
+        get_string(ref_columns[0]["name"]),
+        get_string(ref_columns[ref_columns.size() / 2]["name"])};
+    std::vector<std::string> ref_values, values;
+    get_reader(filename, ValueSink{names, &ref_values, {}}).read_all();
+    WHEN("The data is read with a filter") {
+      cppsas7bdat::Reader reader(
+          cppsas7bdat::datasource::ifstream(convert_path(filename).c_str()),
+          ValueSink{names, &values, {}}, ColumnFilter::Include{names});
+      reader.read_all();
+      THEN("The values are the same") {
+        CHECK(reader.properties().columns.size() == names.size());
+        REQUIRE(values.size() == ref_values.size());
+        CHECK(values == ref_values);
+      }
+    }
+  }
+}
+
+namespace {
+struct PlanSink {
+  DecodePlan plan;
+  DecodePlan::Values values;
+  size_t *rows{nullptr};
+  size_t *errors{nullptr};
+
+  void set_properties(const Properties &_properties) {
+    plan = DecodePlan(_properties.columns);
+    values = plan.make_values();
+  }
+  void push_row(const size_t, Column::PBUF) { CHECK(false); }
+  void push_rows(const RowBatch &_rows) {
+    const auto &c = plan.columns();
+    auto same = [](const NUMBER _x, const NUMBER _y) {
+      return _x == _y || (std::isnan(_x) && std::isnan(_y));
+    };
+    plan.decode(_rows, values, [&](const size_t _irow, const auto &_values) {
+      CHECK(_irow == *rows);
+      const auto p = _rows[_irow - _rows.first_row];
+      for (size_t i = 0; i < c.strings.size(); ++i)
+        *errors += _values.strings[i] != c.strings[i].get_string(p);
+      for (size_t i = 0; i < c.numbers.size(); ++i)
+        *errors += !same(_values.numbers[i], c.numbers[i].get_number(p));
+      for (size_t i = 0; i < c.integers.size(); ++i)
+        *errors += _values.integers[i] != c.integers[i].get_integer(p);
+      for (size_t i = 0; i < c.datetimes.size(); ++i)
+        *errors += _values.datetimes[i] != c.datetimes[i].get_datetime(p);
+      for (size_t i = 0; i < c.dates.size(); ++i)
+        *errors += _values.dates[i] != c.dates[i].get_date(p);
+      for (size_t i = 0; i < c.times.size(); ++i)
+        *errors += _values.times[i] != c.times[i].get_time(p);
+      ++*rows;
+    });
+  }
+  void end_of_data() const noexcept {}
+};
+} // namespace
+
+SCENARIO("When I decode the rows with a decode plan, the values are the same "
+         "as with the column getters",
+         "[interface][read_data][decode_plan]") {
+  const auto data =
+      GENERATE(from_range(files().j.items().begin(), files().j.items().end()));
+
+  const std::string filename = data.key();
+
+  GIVEN(fmt::format("A file {},", filename)) {
+    // Skip big5 files
+    if (filename.find("big5") != filename.npos)
+      return;
+    size_t rows{0}, errors{0};
+    auto reader = get_reader(filename, PlanSink{{}, {}, &rows, &errors});
+    reader.read_all();
+    THEN("All the rows are decoded with the same values") {
+      CHECK(rows == reader.properties().row_count);
+      CHECK(errors == 0);
+    }
+  }
+}
+
+namespace {
+/**
+ *  Write a 64-bit little endian file with _ncols numeric columns named
+ *  COL0, COL1, ... and one row where the column i is i.  The column texts,
+ *  names and attributes are split in subheaders of 4000 columns, as SAS
+ *  does for the wide files.
+ */
+void write_wide_file(const std::string &_filename, const size_t _ncols) {
+  using BYTES = std::vector<uint8_t>;
+  auto put = [](BYTES &_b, const size_t _offset, const auto _x) {
+    const auto x = boost::endian::native_to_little(_x);
+    std::memcpy(_b.data() + _offset, &x, sizeof(x));
+  };
+  auto subheader = [](const size_t _length, const uint8_t _first,
+                      const uint8_t _second) {
+    BYTES b(_length, 0);
+    std::fill_n(b.begin(), 8, uint8_t{0xFF});
+    b[0] = _first;
+    b[1] = _second;
+    return b;
+  };
+  constexpr size_t chunk = 4000, text_start = 40;
+  std::vector<BYTES> subheaders;
+
+  auto row_size = subheader(808, 0xF7, 0xF7);
+  std::fill_n(row_size.begin(), 8, uint8_t{0});
+  std::fill_n(row_size.begin(), 4, uint8_t{0xF7});
+  put(row_size, 40, uint64_t{8 * _ncols}); // row_length
+  put(row_size, 48, uint64_t{1});          // row_count
+  put(row_size, 72, uint64_t{_ncols});     // col_count_p1
+  subheaders.push_back(row_size);
+  auto column_size = subheader(24, 0xF6, 0xF6);
+  std::fill_n(column_size.begin(), 8, uint8_t{0});
+  std::fill_n(column_size.begin(), 4, uint8_t{0xF6});
+  put(column_size, 8, uint64_t{_ncols});
+  subheaders.push_back(column_size);
+
+  std::vector<BYTES> names, attributes;
+  for (size_t first = 0, idx = 0; first < _ncols; first += chunk, ++idx) {
+    const size_t n = std::min(chunk, _ncols - first);
+    std::string text(text_start, '\0');
+    auto name = subheader(8 * n + 28, 0xFF, 0xFF);
+    auto attribute = subheader(16 * n + 20, 0xFC, 0xFF);
+    for (size_t i = 0; i < n; ++i) {
+      const auto column = fmt::format("COL{}", first + i);
+      put(name, 16 + 8 * i, static_cast<uint16_t>(idx));
+      put(name, 18 + 8 * i, static_cast<uint16_t>(text.size()));
+      put(name, 20 + 8 * i, static_cast<uint16_t>(column.size()));
+      text += column;
+      put(attribute, 16 + 16 * i, uint64_t{8 * (first + i)});
+      put(attribute, 24 + 16 * i, uint32_t{8});
+      attribute[30 + 16 * i] = 1; // number
+    }
+    auto column_text = subheader(8 + text.size(), 0xFD, 0xFF);
+    put(column_text, 8, static_cast<uint16_t>(text.size()));
+    std::copy(text.begin() + 2, text.end(), column_text.begin() + 10);
+    subheaders.push_back(column_text);
+    names.push_back(name);
+    attributes.push_back(attribute);
+  }
+  subheaders.insert(subheaders.end(), names.begin(), names.end());
+  subheaders.insert(subheaders.end(), attributes.begin(), attributes.end());
+  for (size_t i = 0; i < _ncols; ++i)
+    subheaders.push_back(subheader(64, 0xFE, 0xFB));
+
+  constexpr size_t header_length = 1024, page_length = 1 << 20;
+  std::vector<BYTES> pages;
+  // The subheaders are stored from the end of the page, their pointers
+  // after the page header.
+  for (size_t i = 0; i < subheaders.size();) {
+    BYTES page(page_length, 0);
+    size_t count = 0, end = page_length;
+    for (; i < subheaders.size(); ++i, ++count) {
+      const auto &b = subheaders[i];
+      if (40 + 24 * (count + 1) + b.size() > end)
+        break;
+      end -= b.size();
+      std::copy(b.begin(), b.end(), page.begin() + static_cast<long>(end));
+      put(page, 40 + 24 * count, uint64_t{end});
+      put(page, 48 + 24 * count, uint64_t{b.size()});
+    }
+    put(page, 32, uint16_t{0}); // meta
+    put(page, 36, static_cast<uint16_t>(count));
+    pages.push_back(page);
+  }
+  BYTES data(page_length, 0);
+  put(data, 32, uint16_t{256}); // data
+  put(data, 34, uint16_t{1});   // one row
+  for (size_t i = 0; i < _ncols; ++i) {
+    const auto x = static_cast<double>(i);
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    put(data, 40 + 8 * i, bits);
+  }
+  pages.push_back(data);
+
+  BYTES header(header_length, 0);
+  const uint8_t magic[] = {0xc2, 0xea, 0x81, 0x60, 0xb3, 0x14, 0x11, 0xcf,
+                           0xbd, 0x92, 0x08, 0x00, 0x09, 0xc7, 0x31, 0x8c,
+                           0x18, 0x1f, 0x10, 0x11};
+  std::copy(std::begin(magic), std::end(magic), header.begin() + 12);
+  header[32] = '3'; // 64 bits
+  header[37] = 0x01; // little endian
+  header[39] = '1';
+  header[70] = 20; // UTF-8
+  put(header, 196, static_cast<uint32_t>(header_length));
+  put(header, 200, static_cast<uint32_t>(page_length));
+  put(header, 204, static_cast<uint32_t>(pages.size()));
+
+  std::ofstream os(_filename, std::ios::binary);
+  os.write(reinterpret_cast<const char *>(header.data()),
+           static_cast<std::streamsize>(header.size()));
+  for (const auto &page : pages)
+    os.write(reinterpret_cast<const char *>(page.data()),
+             static_cast<std::streamsize>(page.size()));
+}
+
+struct ValuesSink {
+  std::vector<NUMBER> *values{nullptr};
+  COLUMNS columns;
+
+  void set_properties(const Properties &_properties) {
+    columns = COLUMNS(_properties.columns);
+  }
+  void push_row(const size_t, Column::PBUF _p) {
+    for (const auto &column : columns)
+      values->push_back(column.get_number(_p));
+  }
+  void end_of_data() const noexcept {}
+};
+} // namespace
+
+SCENARIO("When I read a file with many columns, the filter is applied to "
+         "the names",
+         "[interface][metadata][filter]") {
+  const auto filename =
+      (std::filesystem::temp_directory_path() / "cppsas7bdat_wide.sas7bdat")
+          .string();
+  constexpr size_t ncols = 9000;
+  write_wide_file(filename, ncols);
+
+  GIVEN("No filter") {
+    cppsas7bdat::Reader reader(
+        cppsas7bdat::datasource::ifstream(filename.c_str()), ValuesSink{});
+    const auto &columns = reader.properties().columns;
+    REQUIRE(columns.size() == ncols);
+    CHECK(columns[0].name == "COL0");
+    CHECK(columns[4321].name == "COL4321");
+    CHECK(columns[ncols - 1].name == fmt::format("COL{}", ncols - 1));
+    CHECK(columns[4321].type == Column::Type::number);
+    CHECK(reader.properties().row_count == 1);
+  }
+  GIVEN("An include filter") {
+    const std::set<std::string> names{"COL1", "COL4000", "COL8999", "FOO"};
+    std::vector<NUMBER> values;
+    cppsas7bdat::Reader reader(
+        cppsas7bdat::datasource::ifstream(filename.c_str()),
+        ValuesSink{&values, {}}, ColumnFilter::Include{names});
+    const auto &columns = reader.properties().columns;
+    REQUIRE(columns.size() == 3);
+    CHECK(columns[1].name == "COL4000");
+    // The values are read at the offsets of the selected columns
+    reader.read_all();
+    CHECK(values == std::vector<NUMBER>{1., 4000., 8999.});
+  }
+  GIVEN("An exclude filter") {
+    cppsas7bdat::Reader reader(
+        cppsas7bdat::datasource::ifstream(filename.c_str()), ValuesSink{},
+        ColumnFilter::Exclude{{"COL0", "COL5"}});
+    CHECK(reader.properties().columns.size() == ncols - 2);
+    CHECK(reader.properties().columns[4].name == "COL6");
+  }
+  std::filesystem::remove(filename);
+}
+
+TEST_CASE("Benchmark of the metadata of a wide file", "[.][!benchmark]") {
+  const auto filename =
+      (std::filesystem::temp_directory_path() / "cppsas7bdat_50k.sas7bdat")
+          .string();
+  constexpr size_t ncols = 50000;
+  write_wide_file(filename, ncols);
+  BENCHMARK("50k columns") {
+    return cppsas7bdat::Reader(
+               cppsas7bdat::datasource::ifstream(filename.c_str()),
+               cppsas7bdat::datasink::null())
+        .properties()
+        .columns.size();
+  };
+  BENCHMARK("50k columns, 10 selected") {
+    std::set<std::string> names;
+    for (size_t i = 0; i < 10; ++i)
+      names.insert(fmt::format("COL{}", i * 5000));
+    return cppsas7bdat::Reader(
+               cppsas7bdat::datasource::ifstream(filename.c_str()),
+               cppsas7bdat::datasink::null(), ColumnFilter::Include{names})
+        .properties()
+        .columns.size();
+  };
+  std::filesystem::remove(filename);
+}
+
+namespace {
+struct RowIndexSink {
+  std::vector<size_t> *rows{nullptr};
+
+  void set_properties(const Properties &) const noexcept {}
+  void push_row(const size_t _row_index, Column::PBUF) {
+    rows->push_back(_row_index);
+  }
+  void end_of_data() const noexcept {}
+};
+
+struct ColumnValues {
+  COLUMNS columns;
+  std::vector<std::vector<NUMBER>> numbers;
+  std::vector<std::vector<std::string>> strings;
+
+  void set_properties(const Properties &_properties) {
+    columns = COLUMNS(_properties.columns);
+    numbers.resize(columns.size());
+    strings.resize(columns.size());
+  }
+  void push_row(const size_t, Column::PBUF _p) {
+    for (size_t i = 0; i < columns.size(); ++i) {
+      if (columns[i].type == Column::Type::string)
+        strings[i].emplace_back(columns[i].get_string(_p));
+      else
+        numbers[i].push_back(columns[i].get_number(_p));
+    }
+  }
+  void end_of_data() const noexcept {}
+};
+} // namespace
+
+SCENARIO("When I read a file with a row filter, only the rows accepted are "
+         "pushed to the sink",
+         "[interface][read_data][row_filter]") {
+  const auto data =
+      GENERATE(from_range(files().j.items().begin(), files().j.items().end()));
+  const size_t nthreads = GENERATE(1, 2);
+
+  const std::string filename = data.key();
+
+  GIVEN(fmt::format("A file {} and {} threads,", filename, nthreads)) {
+    // Skip big5 files
+    if (filename.find("big5") != filename.npos)
+      return;
+    ColumnValues ref;
+    {
+      auto reader = get_reader(filename, ref);
+      reader.read_all();
+    }
+    const auto &columns = ref.columns;
+    if (columns.empty() || ref.numbers[0].size() + ref.strings[0].size() < 3)
+      return;
+
+    // A condition on the first column and one on a column in the middle,
+    // built from the values of a few rows.
+    RowFilter::Where where;
+    std::vector<std::function<bool(size_t)>> conditions;
+    for (const size_t icol : {size_t{0}, columns.size() / 2}) {
+      const auto &name = columns[icol].name;
+      if (columns[icol].type == Column::Type::string) {
+        const auto &values = ref.strings[icol];
+        const auto a = values[0], b = values[values.size() / 2];
+        if (icol == 0) {
+          where.in(name, std::vector<std::string>{a, b});
+          conditions.push_back([&values, a, b](size_t i) {
+            return values[i] == a || values[i] == b;
+          });
+        } else {
+          where.greater_equal(name, a);
+          conditions.push_back(
+              [&values, a](size_t i) { return values[i] >= a; });
+        }
+      } else {
+        const auto &values = ref.numbers[icol];
+        const auto a = values[values.size() / 3], b = values[values.size() / 2];
+        const auto lo = std::isnan(a) ? b : std::isnan(b) ? a : std::min(a, b);
+        const auto hi = std::isnan(a) ? b : std::isnan(b) ? a : std::max(a, b);
+        if (icol == 0) {
+          where.between(name, lo, hi);
+          conditions.push_back([&values, lo, hi](size_t i) {
+            return lo <= values[i] && values[i] <= hi;
+          });
+        } else {
+          where.not_equal(name, lo);
+          conditions.push_back([&values, lo](size_t i) {
+            return !std::isnan(values[i]) && values[i] != lo;
+          });
+        }
+      }
+    }
+    const size_t row_count =
+        std::max(ref.numbers[0].size(), ref.strings[0].size());
+    std::vector<size_t> ref_rows;
+    for (size_t i = 0; i < row_count; ++i)
+      if (std::all_of(conditions.begin(), conditions.end(),
+                      [i](const auto &_condition) { return _condition(i); }))
+        ref_rows.push_back(i);
+
+    WHEN("The data is read with a row filter") {
+      std::vector<size_t> rows;
+      auto reader = get_reader(filename, RowIndexSink{&rows});
+      reader.set_row_filter(where);
+      reader.read_all(nthreads);
+      THEN("The rows are the ones accepted") {
+        CHECK(reader.current_row_index() == row_count);
+        CHECK(rows == ref_rows);
+      }
+    }
+    WHEN("The data is read row by row with a row filter") {
+      std::vector<size_t> rows;
+      auto reader = get_reader(filename, RowIndexSink{&rows});
+      reader.set_row_filter(where);
+      while (reader.read_row())
+        ;
+      THEN("The rows are the ones accepted") { CHECK(rows == ref_rows); }
+    }
+    WHEN("The data is read with a row filter on a column not read") {
+      auto reader = get_reader(filename);
+      THEN("An exception is thrown") {
+        CHECK_THROWS(reader.set_row_filter(
+            RowFilter::Where().equal("__not_a_column__", 0.)));
+      }
+    }
+    WHEN("The data is read with a value not of the type of the column") {
+      auto reader = get_reader(filename);
+      const auto &name = columns[0].name;
+      THEN("An exception is thrown") {
+        if (columns[0].type == Column::Type::string)
+          CHECK_THROWS(
+              reader.set_row_filter(RowFilter::Where().equal(name, 0.)));
+        else
+          CHECK_THROWS(
+              reader.set_row_filter(RowFilter::Where().equal(name, "0")));
+      }
+    }
+  }
+}
+
+SCENARIO("The rows of a sample are distinct, sorted and reproducible",
+         "[interface][sample]") {
+  GIVEN("A systematic sample") {
+    CHECK(Sample::systematic(10, 3) == std::vector<size_t>{0, 3, 6, 9});
+    CHECK(Sample::systematic(10, 4, 2) == std::vector<size_t>{2, 6});
+    CHECK(Sample::systematic(10, 0).empty());
+    CHECK(Sample::systematic(10, 3, 10).empty());
+  }
+  GIVEN("A random sample") {
+    const size_t row_count = GENERATE(1, 100, 1000000000000);
+    const size_t count = GENERATE(0, 1, 50, 1000);
+    const auto rows = Sample::random(row_count, count, 42);
+    THEN("The rows are distinct, sorted and within the file") {
+      CHECK(rows.size() == std::min(row_count, count));
+      CHECK(std::adjacent_find(rows.begin(), rows.end(),
+                               std::greater_equal<size_t>()) == rows.end());
+      CHECK((rows.empty() || rows.back() < row_count));
+    }
+    THEN("The rows only depend on the seed") {
+      CHECK(Sample::random(row_count, count, 42) == rows);
+      if (count > 1 && count < row_count)
+        CHECK(Sample::random(row_count, count, 43) != rows);
+    }
+  }
+}
+
+namespace {
+struct SampleSink {
+  std::vector<std::pair<size_t, std::vector<uint8_t>>> *rows{nullptr};
+  size_t row_length{0};
+
+  void set_properties(const Properties &_properties) {
+    row_length = _properties /*.metadata*/.row_length;
+  }
+  void push_row(const size_t _row_index, Column::PBUF _p) {
+    const auto b = static_cast<const uint8_t *>(_p);
+    rows->emplace_back(_row_index, std::vector<uint8_t>(b, b + row_length));
+  }
+  void end_of_data() const noexcept {}
+};
+} // namespace
+
+SCENARIO("When I read a sample of the rows, the rows are the same as when the "
+         "file is read entirely",
+         "[interface][read_data][sample]") {
+  const auto data =
+      GENERATE(from_range(files().j.items().begin(), files().j.items().end()));
+
+  const bool is_random = GENERATE(true, false);
+
+  const std::string filename = data.key();
+
+  GIVEN(fmt::format("A file {} and a {} sample,", filename,
+                    is_random ? "random" : "systematic")) {
+    // Skip big5 files
+    if (filename.find("big5") != filename.npos)
+      return;
+    std::vector<std::pair<size_t, std::vector<uint8_t>>> ref_rows;
+    get_reader(filename, SampleSink{&ref_rows, 0}).read_all();
+    const size_t row_count = ref_rows.size();
+
+    const auto sample =
+        is_random ? Sample::random(row_count, 10, 2024)
+                  : Sample::systematic(row_count,
+                                       std::max<size_t>(row_count / 7, 1), 3);
+
+    auto check = [&](auto &&_source) {
+      std::vector<std::pair<size_t, std::vector<uint8_t>>> rows;
+      cppsas7bdat::Reader reader(std::move(_source), SampleSink{&rows, 0});
+      CHECK(reader.read_sample(sample));
+      REQUIRE(rows.size() == sample.size());
+      for (size_t i = 0; i < rows.size(); ++i)
+        CHECK(rows[i] == ref_rows[sample[i]]);
+    };
+    WHEN("The sample is read with a seekable data source") {
+      check(cppsas7bdat::datasource::ifstream(convert_path(filename).c_str()));
+    }
+    WHEN("The sample is read with a data source that is not seekable") {
+      check(forward_only{
+          cppsas7bdat::datasource::ifstream(convert_path(filename).c_str())});
+    }
+  }
+}
+
+TEST_CASE("Benchmark of the sampling", "[.][!benchmark]") {
+  const std::string filename = "data_AHS2013/homimp.sas7bdat";
+  const auto path = convert_path(filename);
+  const size_t row_count = get_reader(filename).properties().row_count;
+  BENCHMARK("All the rows") {
+    auto reader = cppsas7bdat::Reader(
+        cppsas7bdat::datasource::mmap(path.c_str()),
+        cppsas7bdat::datasink::null());
+    reader.read_all();
+    return reader.current_row_index();
+  };
+  BENCHMARK("100 random rows") {
+    auto reader = cppsas7bdat::Reader(
+        cppsas7bdat::datasource::mmap(path.c_str()),
+        cppsas7bdat::datasink::null());
+    return reader.read_sample(Sample::random(row_count, 100, 42));
+  };
+}
@@ -195,6 +195,77 @@ SCENARIO("When I read a file, the metadata is set properly",
 
 #include <charconv>
 
+namespace {
+struct forward_only {
+  cppsas7bdat::datasource::ifstream source;
+
+  bool eof() { return source.eof(); }
+  bool read_bytes(void *_p, const size_t _length) {
+    return source.read_bytes(_p, _length);
+  }
+};
+} // namespace
+
+SCENARIO("When I read the pages of a file in any order, they are the same as "
+         "when read sequentially",
+         "[internal][read_page]") {
+  const auto data =
+      GENERATE(from_range(files().j.items().begin(), files().j.items().end()));
+
+  const std::string filename = data.key();
+
+  GIVEN(fmt::format("A file {},", filename)) {
+    // Skip big5 files
+    if (filename.find("big5") != filename.npos)
+      return;
+    cppsas7bdat::Properties::Header header;
+    cppsas7bdat::Properties::Metadata metadata;
+    WHEN("The pages are read with a seekable data source") {
+      auto rm = cppsas7bdat::READ::metadata(open_file(filename), &header,
+                                            &metadata, {});
+      THEN("The pages read backward are the same as the pages read forward") {
+        std::visit(
+            [&](auto &&arg) {
+              const size_t npages = arg.page_count();
+              auto get_page = [&]() {
+                const auto bytes = arg.buf.as_bytes();
+                return std::vector<uint8_t>(bytes.begin(), bytes.end());
+              };
+              std::vector<std::vector<uint8_t>> pages;
+              for (size_t ipage = 0; ipage < npages; ++ipage) {
+                REQUIRE(arg.read_page(ipage));
+                pages.emplace_back(get_page());
+              }
+              for (size_t ipage = npages; ipage-- > 0;) {
+                CHECK(arg.read_page(ipage));
+                CHECK(get_page() == pages[ipage]);
+              }
+              CHECK_FALSE(arg.read_page(npages));
+            },
+            rm);
+      }
+    }
+    WHEN("The pages are read with a data source that is not seekable") {
+      auto rm = cppsas7bdat::READ::metadata(
+          cppsas7bdat::Reader::build_source(forward_only{
+              cppsas7bdat::datasource::ifstream(
+                  convert_path(filename).c_str())}),
+          &header, &metadata, {});
+      THEN("The pages can only be read forward") {
+        std::visit(
+            [&](auto &&arg) {
+              CHECK(arg.page_count() == 0);
+              const size_t ipage = arg.page_index;
+              REQUIRE(ipage > 0);
+              CHECK_FALSE(arg.seek_page(ipage - 1));
+              CHECK(arg.seek_page(ipage));
+            },
+            rm);
+      }
+    }
+  }
+}
+
 SCENARIO("When I read a file, the data are read properly",
          "[internal][read_data]") {
   const auto data =
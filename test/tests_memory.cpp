@@ -6,6 +6,7 @@
  *  \author  Olivia Quinet
  */
 
+#include "../src/sas7bdat-impl.hpp"
 #include "../src/memory.hpp"
 #include <catch2/catch_test_macros.hpp>
 #include <iostream>
@@ -32,3 +33,28 @@ SCENARIO("If the system cannot allocate memory, an exception is thrown",
          "[memory]") {
   CHECK_THROWS(alloc_and_init(std::numeric_limits<size_t>::max() / 2));
 }
+
+namespace {
+struct ViewSource {
+  const uint8_t *bytes;
+  const void *view_bytes(const size_t) const noexcept { return bytes; }
+  bool read_bytes(void *, const size_t) const noexcept { return false; }
+};
+} // namespace
+
+SCENARIO("When I write to a buffer viewing a data source, the view is copied "
+         "first",
+         "[memory]") {
+  const uint8_t bytes[4] = {1, 2, 3, 4};
+  ViewSource source{bytes};
+  auto psource = &source;
+  INTERNAL::MBUFFER buffer;
+  REQUIRE(buffer.read_stream(psource, sizeof(bytes)));
+  REQUIRE(buffer.is_view());
+  buffer.set(1, 42);
+  CHECK(buffer.is_view() == false);
+  CHECK(buffer[0] == 1);
+  CHECK(buffer[1] == 42);
+  CHECK(buffer[3] == 4);
+  CHECK(bytes[1] == 2);
+}